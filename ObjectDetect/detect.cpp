@@ -12,6 +12,27 @@
 #include <opencv2/opencv.hpp>
 #include "funcs.hpp"
 
+/**
+ * @brief Check the settings, before a Detection is built with them.
+ *
+ * @param void void.
+ * 
+ * @return void. Throws `std::runtime_error` if a setting is out of range.
+ * 
+ */
+void detectConfig::validate(void) const{
+
+    if(period < 2){
+
+        throw std::runtime_error("ERR:Period must greater than 1");
+    }
+
+    if(adaptive && (min_period < 2 || max_period < min_period)){
+
+        throw std::runtime_error("ERR:Period bounds must greater than 1 and ordered");
+    }
+}
+
 /**
  * @brief Get the bounding box of Detected object.
  * 
@@ -61,7 +82,7 @@ bool objDetect::tick(const Mat& frame){
         Mat fd_diff;
         cv::absdiff(cur_frm_blur, pre_frm_blur, fd_diff);
 
-        cv::threshold(fd_diff, _fd_resp, FD_THRESHOLD, 255, cv::THRESH_BINARY);
+        cv::threshold(fd_diff, _fd_resp, _cfg.fd_threshold, 255, cv::THRESH_BINARY);
     
 
         /* Process response, get detected objects. */
@@ -78,12 +99,18 @@ bool objDetect::tick(const Mat& frame){
     }
 
 
+    if(_cfg.adaptive){
+        adaptPeriod(cur_frame, pre_frame);
+    }
+
     /* Only process once per period. */
-    if((_clock % _period) > 0U){
+    if(++ _since_detect < _period){
 
         return false;
     }
 
+    _since_detect = 0;
+
     /* Background Frame Difference. */
     vector<Rect> obj_rects;
 
@@ -120,6 +147,121 @@ bool objDetect::tick(const Mat& frame){
     return false;
 }
 
+/**
+ * @brief Choose the detection interval from scene activity, tracker confidence and frame time.
+ * 
+ * Activity is the ratio of pixels changed since the previous frame, on one row in every 
+ * `DETEC_ACTIVITY_ROW_STEP`, smoothed. The wanted interval is:
+ * - the upper bound when frames run out of time, or when the scene is idle and all trackers are 
+ *   confident;
+ * - the lower bound when the scene is busy and some trackers are not confident, e.g. people 
+ *   entering;
+ * - the configured interval otherwise.
+ * 
+ * A shorter interval is taken at once. A longer one must stay wanted for `DETEC_HOLD` frames, 
+ * then the interval grows by one frame. Together with the two activity thresholds, 
+ * this keeps the interval from swinging back and forth.
+ *
+ * @param cur_frame     Current gray frame.
+ * @param pre_frame     Previous gray frame.
+ * 
+ * @return Boolean value. Return `true` if the interval changed.
+ * 
+ */
+bool objDetect::adaptPeriod(const Mat& cur_frame, const Mat& pre_frame){
+
+    const int rows = cur_frame.rows / DETEC_ACTIVITY_ROW_STEP;
+
+    if(rows == 0 || pre_frame.size() != cur_frame.size()){
+        return false;
+    }
+
+    /* Sampled rows as views with a longer row step, nothing is copied. */
+    const Mat cur_rows(rows, cur_frame.cols, CV_8UC1, cur_frame.data, cur_frame.step * DETEC_ACTIVITY_ROW_STEP);
+    const Mat pre_rows(rows, pre_frame.cols, CV_8UC1, pre_frame.data, pre_frame.step * DETEC_ACTIVITY_ROW_STEP);
+
+    cv::absdiff(cur_rows, pre_rows, _activity_diff);
+    cv::threshold(_activity_diff, _activity_diff, _cfg.fd_threshold, 255, cv::THRESH_BINARY);
+
+    float ratio = 1.0f * cv::countNonZero(_activity_diff) / (rows * cur_frame.cols);
+    _activity = (1.0f - DETEC_ACTIVITY_ALPHA) * _activity + DETEC_ACTIVITY_ALPHA * ratio;
+
+    if(_activity > _cfg.activity_high){
+        _busy = true;
+    }
+    else if(_activity < _cfg.activity_low){
+        _busy = false;
+    }
+
+    const int weak_tcrs = _weak_tcrs.load(std::memory_order_relaxed);
+    const float frame_ms = _frame_ms.load(std::memory_order_relaxed);
+
+    const bool overloaded = _cfg.frame_budget_ms > 0.0f 
+                            && frame_ms > (1.0f - DETEC_MIN_HEADROOM) * _cfg.frame_budget_ms;
+
+    const uint_fast32_t min_period = _cfg.min_period, max_period = _cfg.max_period;
+    uint_fast32_t wanted = MIN(MAX((uint_fast32_t)_cfg.period, min_period), max_period);
+
+    if(overloaded || (false == _busy && weak_tcrs == 0)){
+        wanted = max_period;
+    }
+    else if(_busy && weak_tcrs > 0){
+        wanted = min_period;
+    }
+
+    const uint_fast32_t period = _period;
+
+    if(wanted < _period){
+
+        _period = wanted;
+        _hold = 0;
+    }
+    else if(wanted > _period){
+
+        if(++ _hold >= DETEC_HOLD){
+
+            ++ _period;
+            _hold = 0;
+        }
+    }
+    else{
+        _hold = 0;
+    }
+
+    return _period != period;
+}
+
+/**
+ * @brief Report how Tracking is doing, for the adaptive interval. It may be called from 
+ *        another thread than `tick`.
+ *
+ * @param weak_tcrs     Running trackers whose latest response failed the APCE test.
+ * @param frame_ms      Time the latest frame took, in milliseconds. It's smoothed.
+ * 
+ * @return Boolean value. Return `true` if the report goes on properly. 
+ * 
+ */
+bool objDetect::setFeedback(int weak_tcrs, float frame_ms){
+
+    _weak_tcrs.store(weak_tcrs, std::memory_order_relaxed);
+
+    /* Only the reporting thread writes it, a plain read-modify-write is enough. */
+    float mean_ms = _frame_ms.load(std::memory_order_relaxed);
+    mean_ms = (mean_ms <= 0.0f) ? frame_ms : (1.0f - DETEC_ACTIVITY_ALPHA) * mean_ms + DETEC_ACTIVITY_ALPHA * frame_ms;
+    _frame_ms.store(mean_ms, std::memory_order_relaxed);
+
+    return true;
+}
+
+/**
+ * @brief Get the current interval between two detections.
+ *
+ */
+uint_fast32_t objDetect::getPeriod(void) const{
+
+    return _period;
+}
+
 /**
  * @brief Get background frame difference response, and use a kernel to mitigate fragmentations.
  * 
@@ -150,7 +292,7 @@ bool objDetect::getBackgrndDiffResp(const Mat& cur_frame, Mat& final_resp){
     Mat high_thresh_resp, low_thresh_resp;
 
     const Size kernel(1,9);
-    const int low_thresh = 15, high_thresh = 50, max_val = 255;
+    const int low_thresh = _cfg.low_threshold, high_thresh = _cfg.high_threshold, max_val = 255;
 
     cv::threshold(backgrnd_diff, low_thresh_resp, low_thresh, max_val, cv::THRESH_BINARY);
     cv::threshold(backgrnd_diff, high_thresh_resp, high_thresh, max_val, cv::THRESH_BINARY);
@@ -275,7 +417,7 @@ vector<Rect> objDetect::getRects(Mat resp) {
 
         Rect bbox = cv::boundingRect(contour);
         
-        if (bbox.height > MIN_BBOX_HEIGHT && bbox.width > MIN_BBOX_WIDTH) { 
+        if (bbox.height > _cfg.min_bbox_height && bbox.width > _cfg.min_bbox_width) { 
             objects.push_back(bbox);
         }
     }
@@ -11,18 +11,45 @@ using std::vector;
 #include <queue>
 
 #include <stdint.h>
+#include <atomic>
 
 /* Frame Difference threshold. */
 #define FD_THRESHOLD (15)
 #define BAKCGRND_THRESHOLD (25)
+
+/* Background Difference thresholds. Weak responses only count next to strong ones. */
+#define BAKCGRND_LOW_THRESHOLD (15)
+#define BAKCGRND_HIGH_THRESHOLD (50)
 #define MIN_BBOX_HEIGHT (20)
 #define MIN_BBOX_WIDTH (10)
 
 /* Detect Objects every DETEC_INTV frames. */
 #define DETEC_INTV (5)
 
-/* Miminum frames number requirement for detection. */
-#define MIN_DETEC_FRM_REQ ( DETEC_INTV / 2 + 1)
+/* Adapt the interval at runtime, within [DETEC_MIN_INTV, DETEC_MAX_INTV], starting from DETEC_INTV.
+   It shortens at once when the scene gets busy and trackers lose confidence, and grows back 
+   one frame at a time when the scene is idle or frames run out of time. Off by default, so the 
+   interval stays DETEC_INTV unless enabled at runtime. */
+#define DETEC_ADAPTIVE (false)
+#define DETEC_MIN_INTV (2)
+#define DETEC_MAX_INTV (15)
+
+/* Ratio of pixels changed between consecutive frames, smoothed. The scene turns busy above the 
+   high ratio, and idle again only below the low one. */
+#define DETEC_ACTIVITY_LOW (0.001f)
+#define DETEC_ACTIVITY_HIGH (0.004f)
+#define DETEC_ACTIVITY_ALPHA (0.2f)
+
+/* The change ratio samples one row in every DETEC_ACTIVITY_ROW_STEP. */
+#define DETEC_ACTIVITY_ROW_STEP (4)
+
+/* Frames a longer interval must stay wanted before it grows by one. */
+#define DETEC_HOLD (10)
+
+/* Time a frame may take. Less than DETEC_MIN_HEADROOM of it left counts as overloaded. 
+   0 ignores frame time. */
+#define DETEC_FRAME_BUDGET_MS (1000.0f / frameRate)
+#define DETEC_MIN_HEADROOM (0.2f)
 
 /* Size of frames buffer. Use 2 Frames Difference, so the size is 2. */
 #define FRM_BUFFER_SIZE (2)
@@ -64,6 +91,33 @@ protected:
 };
 
 
+/**
+ * @struct detectConfig
+ * @brief Runtime settings of the Detection. Defaults are the macros above.
+ * 
+ */
+struct detectConfig{
+
+    explicit detectConfig(int period = DETEC_INTV): period(period) {}
+
+    int period;
+    int fd_threshold = FD_THRESHOLD;
+    int low_threshold = BAKCGRND_LOW_THRESHOLD;
+    int high_threshold = BAKCGRND_HIGH_THRESHOLD;
+    int min_bbox_height = MIN_BBOX_HEIGHT;
+    int min_bbox_width = MIN_BBOX_WIDTH;
+
+    bool adaptive = DETEC_ADAPTIVE;
+    int min_period = DETEC_MIN_INTV;
+    int max_period = DETEC_MAX_INTV;
+    float activity_low = DETEC_ACTIVITY_LOW;
+    float activity_high = DETEC_ACTIVITY_HIGH;
+    float frame_budget_ms = DETEC_FRAME_BUDGET_MS;
+
+    void validate(void) const;
+};
+
+
 /**
  * @class objDetect
  * @brief Handle the whole Detection process.
@@ -75,11 +129,15 @@ public:
 
     objDetect():_period(0) {}
 
-    objDetect(const Mat& frame, int period = DETEC_INTV):_period(period){
+    objDetect(const Mat& frame, int period = DETEC_INTV):objDetect(frame, detectConfig(period)) {}
+
+    objDetect(const Mat& frame, const detectConfig& cfg):_cfg(cfg), _period(cfg.period){
         
-        if(_period < 2){
+        _cfg.validate();
 
-            throw std::runtime_error("ERR:Period must greater than 1");
+        if(_cfg.adaptive){
+
+            _period = MIN(MAX(_period, (uint_fast32_t)_cfg.min_period), (uint_fast32_t)_cfg.max_period);
         }
 
         _p_frms = new Mat[FRM_BUFFER_SIZE];
@@ -108,8 +166,15 @@ public:
 
     bool getBackgrndDiffResp(const Mat& cur_frame, Mat& final_resp);
 
+    bool setFeedback(int weak_tcrs, float frame_ms);
+
+    uint_fast32_t getPeriod(void) const;
+
 
 protected:
+
+    bool adaptPeriod(const Mat& cur_frame, const Mat& pre_frame);
+
     vector<fdObject> _objs;
     vector<fdObject> _res;
     vector<Rect> _tracked_ROIs;
@@ -130,9 +195,26 @@ protected:
     float _alpha_init = 0.8;
     float _alpha = 0.1;    
 
+    /* Thresholds and sizes. */
+    const detectConfig _cfg = detectConfig();
+
     /* The interval between two detections. 
        Small interval doesn't indicate better performance. */
-    const uint_fast32_t _period;
+    uint_fast32_t _period;
+
+    /* Frames since the last detection. Starts as the clock, so a fixed interval detects 
+       on the same frames as counting the clock modulo the interval. */
+    uint_fast32_t _since_detect = 1;
+
+    /* Adaptive interval. Smoothed change ratio, scene state, and frames the growth has waited. */
+    float _activity = 0.0f;
+    bool _busy = false;
+    int _hold = 0;
+    Mat _activity_diff;
+
+    /* Set by Tracking, possibly from another thread. */
+    std::atomic<int> _weak_tcrs{0};
+    std::atomic<float> _frame_ms{0.0f};
 
     /* 64 bits could be faster than 32 bits in 64 bits platform. 
        uint_fast32_t can handle it. */
@@ -0,0 +1,216 @@
+
+/**
+ * @file reid.cpp
+ * @brief Re-identification of lost tracks for the MOT system.
+ * @author wantSomeChips
+ * @date 2025
+ * 
+ */
+
+#include "reid.hpp"
+
+#include <cmath>
+
+/**
+ * @brief Remember a lost track. 
+ * 
+ * If the gallery is full, the entry lost for the longest time is evicted.
+ *
+ * @param id        ID of the lost track.
+ * @param desc      Appearance descriptor, a single row or column of floats.
+ * @param roi       Last bounding box of the track.
+ * @param velocity  Velocity of the box center, in pixels per frame.
+ * @param clock     Frame when the track was lost.
+ * @param p_kcf     KCF tracker of the track. The gallery takes the ownership.
+ * 
+ * @return The KCF tracker no longer needed, evicted or rejected, or `nullptr`. 
+ *         The caller takes its ownership.
+ * 
+ */
+KCFTracker* reidGallery::push(int id, const Mat& desc, Rect roi, cv::Point2f velocity, 
+    uint_fast32_t clock, KCFTracker* p_kcf){
+
+    if(_size <= 0 || desc.empty()){
+        return p_kcf;
+    }
+
+    if(_descs.empty()){
+        _descs = Mat(_size, desc.total(), CV_32FC1, cv::Scalar(0.0f));
+    }
+
+    /* Descriptors of another feature setting can't be compared. */
+    if((int)desc.total() != _descs.cols){
+        return p_kcf;
+    }
+
+    /* Take a free entry, or the oldest one. */
+    int entry = 0;
+    for(int e = 0; e < _size; ++ e){
+
+        if(_ids[e] == INVALID_ID){
+            entry = e;
+            break;
+        }
+
+        if(_clocks[e] < _clocks[entry]){
+            entry = e;
+        }
+    }
+
+    KCFTracker* p_evicted = _p_kcfs[entry];
+
+    Mat row = _descs.row(entry);
+    desc.reshape(1, 1).convertTo(row, CV_32F);
+
+    _ids[entry] = id;
+    _rois[entry] = roi;
+    _velocities[entry] = velocity;
+    _clocks[entry] = clock;
+    _p_kcfs[entry] = p_kcf;
+
+    return p_evicted;
+}
+
+/**
+ * @brief Find the lost track a detected object most likely belongs to.
+ * 
+ * An entry is a candidate only when the detection is close to where the lost track is predicted 
+ * to be by its last velocity. The candidate with the most similar appearance wins, if the 
+ * similarity reaches the minimum requirement. 
+ * 
+ * Appearance similarity uses the same Gaussian kernel as the cost matrix of association.
+ *
+ * @param desc      Appearance descriptor of the detected object.
+ * @param roi       Bounding box of the detected object.
+ * @param clock     Current frame.
+ * 
+ * @return Index of the matched entry, or `INVALID_INDEX`.
+ * 
+ */
+int reidGallery::match(const Mat& desc, Rect roi, uint_fast32_t clock) const{
+
+    if(_descs.empty() || (int)desc.total() != _descs.cols){
+        return INVALID_INDEX;
+    }
+
+    Mat query;
+    desc.reshape(1, 1).convertTo(query, CV_32F);
+
+    const float* p_query = query.ptr<float>(0);
+    const int dim = _descs.cols;
+
+    const float sigma = 0.05f;
+    const float cx = roi.x + roi.width / 2.0f;
+    const float cy = roi.y + roi.height / 2.0f;
+
+    int best = INVALID_INDEX;
+    float best_sim = _min_sim;
+
+    for(int e = 0; e < _size; ++ e){
+
+        if(_ids[e] == INVALID_ID){
+            continue;
+        }
+
+        const float age = clock - _clocks[e];
+        if(age > _max_age){
+            continue;
+        }
+
+        /* Gate by predicted position. */
+        const Rect& last = _rois[e];
+        float dx = last.x + last.width / 2.0f + _velocities[e].x * age - cx;
+        float dy = last.y + last.height / 2.0f + _velocities[e].y * age - cy;
+        float gate = _gate_ratio * last.height * (1.0f + age / _max_age);
+
+        if(dx * dx + dy * dy > gate * gate){
+            continue;
+        }
+
+        /* Squared distance over one contiguous row, vectorized by the compiler. */
+        const float* p_desc = _descs.ptr<float>(e);
+        float dist = 0.0f;
+        for(int i = 0; i < dim; ++ i){
+            float diff = p_desc[i] - p_query[i];
+            dist += diff * diff;
+        }
+
+        float sim = std::exp(- dist / (2 * sigma * sigma));
+
+        if(sim >= best_sim){
+            best_sim = sim;
+            best = e;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Take a lost track out of the gallery, to revive it.
+ *
+ * @param entry     Index of the entry.
+ * @param id        ID of the lost track. This is the result of this function.
+ * 
+ * @return KCF tracker of the lost track. The caller takes its ownership.
+ * 
+ */
+KCFTracker* reidGallery::take(int entry, int& id){
+
+    KCFTracker* p_kcf = _p_kcfs[entry];
+    id = _ids[entry];
+
+    _ids[entry] = INVALID_ID;
+    _p_kcfs[entry] = nullptr;
+
+    return p_kcf;
+}
+
+/**
+ * @brief Forget lost tracks older than the maximum age.
+ *
+ * @param clock     Current frame.
+ * 
+ * @return KCF trackers of the forgotten tracks. The caller takes their ownership.
+ * 
+ */
+vector<KCFTracker*> reidGallery::expire(uint_fast32_t clock){
+
+    vector<KCFTracker*> res;
+
+    for(int e = 0; e < _size; ++ e){
+
+        if(_ids[e] != INVALID_ID && clock - _clocks[e] > (uint_fast32_t)_max_age){
+
+            if(_p_kcfs[e] != nullptr){
+                res.push_back(_p_kcfs[e]);
+            }
+
+            _ids[e] = INVALID_ID;
+            _p_kcfs[e] = nullptr;
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @brief Get the number of lost tracks remembered.
+ *
+ * @param void void.
+ * 
+ * @return The number of lost tracks remembered.
+ * 
+ */
+int reidGallery::count(void) const{
+
+    int res = 0;
+
+    for(int id: _ids){
+        if(id != INVALID_ID){
+            ++ res;
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef _REID_H_
+#define _REID_H_
+
+
+#include "funcs.hpp"
+#include "kcftracker.hpp"
+
+#include <stdint.h>
+
+/* Maximum lost tracks remembered at the same time. */
+#define REID_GALLERY_SIZE (16)
+
+/* Lost tracks older than REID_MAX_AGE frames are forgotten. */
+#define REID_MAX_AGE (90)
+
+/* Minimum appearance similarity for re-identification. */
+#define REID_MIN_SIM (0.6f)
+
+/* Maximum distance between predicted and detected centers, in heights of the lost box. 
+   It's doubled for the oldest lost tracks. */
+#define REID_GATE_RATIO (1.0f)
+
+
+
+/**
+ * @class reidGallery
+ * @brief A fixed-size gallery of recently lost tracks, used to re-identify returning objects.
+ * 
+ * Each entry keeps a compact appearance descriptor, the last position and velocity, and the 
+ * KCF model of a lost track. Descriptors are stored row by row in one contiguous matrix, 
+ * so matching a detection against the whole gallery is a single pass over it.
+ * 
+ * The gallery owns the KCF trackers it stores until they are taken back or evicted.
+ * 
+ */
+class reidGallery{
+
+public:
+
+    reidGallery(int size = REID_GALLERY_SIZE, int max_age = REID_MAX_AGE, 
+                float min_sim = REID_MIN_SIM, float gate_ratio = REID_GATE_RATIO)
+                :_size(size), _max_age(max_age), _min_sim(min_sim), _gate_ratio(gate_ratio){
+
+        _ids.assign(_size, INVALID_ID);
+        _rois.resize(_size);
+        _velocities.resize(_size);
+        _clocks.assign(_size, 0);
+        _p_kcfs.assign(_size, nullptr);
+    }
+
+    ~reidGallery(){
+        for(KCFTracker* p_kcf: _p_kcfs){
+            if(p_kcf != nullptr){
+                delete p_kcf;
+            }
+        }
+    }
+
+    KCFTracker* push(int id, const Mat& desc, Rect roi, cv::Point2f velocity, 
+        uint_fast32_t clock, KCFTracker* p_kcf);
+
+    int match(const Mat& desc, Rect roi, uint_fast32_t clock) const;
+
+    KCFTracker* take(int entry, int& id);
+
+    vector<KCFTracker*> expire(uint_fast32_t clock);
+
+    int count(void) const;
+
+    static const int INVALID_ID = -1;
+
+protected:
+
+    const int _size;
+    const int _max_age;
+    const float _min_sim;
+    const float _gate_ratio;
+
+    /* Appearance descriptors, one row per entry. Allocated with the first entry. */
+    Mat _descs;
+
+    vector<int> _ids;
+    vector<Rect> _rois;
+    vector<cv::Point2f> _velocities;
+
+    /* Frame when the track was lost. */
+    vector<uint_fast32_t> _clocks;
+
+    vector<KCFTracker*> _p_kcfs;
+
+};
+
+
+#endif
@@ -14,6 +14,20 @@
 #include "ffttools.hpp"
 
 #include <cstdio>
+#include <ctime>
+#include <algorithm>
+
+/* CPU time of the calling thread in milliseconds, wall time where that isn't available. */
+static double threadMs(void){
+
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#else
+    return 1000.0 * cv::getTickCount() / cv::getTickFrequency();
+#endif
+}
 
 /**
  * @brief Top-level abstract function for the object Tracking. Handle the Tracking logic.
@@ -26,56 +40,130 @@
  * @return Boolean value. Return `true` if the Tracking goes on properly. 
  * 
  */
-bool objTrack::tick(Mat& frame, vector<fdObject> fd_objs){
+bool objTrack::tick(const Mat& frame, vector<fdObject> fd_objs){
 
     // cout << "DEBUG:objTrack-tick - fd_objs.size: " << fd_objs.size() << endl;
 
+    ++ _clock;
+
     if(fd_objs.empty()) {
-        for(int i = 0; i < max_tcr; ++ i){
 
-            Tracking& cur_tcr = _p_tcrs[i];
-    
-            if(IS_SAME_STATE(cur_tcr.state, TCR_RUNN)){
-                cur_tcr.update(frame);
+        vector<int> tcr_index;
+        vector<char> modes;
+        scheduleUpdates(tcr_index, modes);
+
+        for(int i = 0; i < (int)tcr_index.size(); ++ i){
+
+            if(modes[i] == TCR_UPD_DEFER){
+                tcrAt(tcr_index[i]).defer();
             }
         }
+        timedUpdates(tcr_index, modes, frame);
+
         return true;
     }
 
+    /* Only running and lost trackers take part in matching, each row of `cost` is one of them. 
+       Matching moves trackers between running and lost only, so the rows stay in place. */
+    const vector<int> tcr_index = _soa.tcr_index;
+
     Mat cost;
     getCostMatrix(frame, fd_objs, cost);
 
-    vector<int> matched_tcr_index;
-    hungarianMatch(fd_objs, cost, matched_tcr_index);
+    vector<int> matched_tcr_row;
+    hungarianMatch(fd_objs, cost, matched_tcr_row);
 
-    vector<bool> tcr_matched(max_tcr, false);
+    vector<bool> row_matched(tcr_index.size(), false);
 
     int n = fd_objs.size();
 
-    /* Update only when cost less than `max_cost_allowed`. Otherwise, `restart` it. */
-    float max_cost_allowed = 0.5f;
+    /* Update only when cost less than `max_cost_allowed`. Otherwise, `restart` it. 
+       Updates of different trackers are independent, they are done together afterwards. */
+    float max_cost_allowed = _cfg.max_cost;
+    vector<int> update_index;
+
+    /* Trackers matched or started in this frame, never taken over by a new track. */
+    vector<int> keep_index;
+
     for(int i = 0; i < n; ++ i){
-        int index = matched_tcr_index[i];
+        int row = matched_tcr_row[i];
         /* If sucessfully matched a tracker. */
-        if(index != INVALID_INDEX){
+        if(row != INVALID_INDEX){
+
+            row_matched[ row ] = true;
 
-            tcr_matched[ index ] = true;
-            Tracking& cur_tcr = _p_tcrs[ index ];
+            int index = tcr_index[ row ];
+            keep_index.push_back(index);
 
-            if(cost.at<float>(index,i) < max_cost_allowed){
+            if(cost.at<float>(row,i) < max_cost_allowed){
 
-                cur_tcr.update(frame);
+                update_index.push_back(index);
             }
             else{
-                cur_tcr.restart(frame, fd_objs[i].resultRect());
+                setTcrState(index, TCR_RUNN);
+                tcrAt(index).restart(frame, fd_objs[i].resultRect(), _cfg);
+                _soa.sync(index, tcrAt(index));
             }
         }
-        else{
+    }
 
-            int index = getFreeTcrIndex();
-            
-            tcr_matched[ index ] = true;
-            _p_tcrs[index].restart(frame, fd_objs[i].resultRect());
+    timedUpdates(update_index, vector<char>(update_index.size(), TCR_UPD_FULL), frame);
+
+    /* Forget lost tracks too old to come back. */
+    for(KCFTracker* p_kcf: _gallery.expire(_clock)){
+        recycleKCF(p_kcf);
+    }
+
+    /* Start new trackers after all matched ones are handled. A tracker matched or started 
+       in this frame is not taken over, detections left when only those remain start nothing. */
+    vector<int> new_index;
+    for(int i = 0; i < n; ++ i){
+
+        if(matched_tcr_row[i] == INVALID_INDEX){
+
+            Rect fd_roi = fd_objs[i].resultRect();
+
+            int index = getFreeTcrIndex(keep_index);
+
+            if(index == INVALID_INDEX){
+                break;
+            }
+
+            /* Keep the lost track for re-identification before its tracker is taken over. 
+               Archiving may evict an entry of a full gallery, so it comes before matching. */
+            if(IS_SAME_STATE(tcrAt(index).state, TCR_LOST)){
+                archiveTcr(index);
+            }
+
+            /* A returning object takes back its ID and KCF model. */
+            int entry = _gallery.match(_fd_features[i], fd_roi, _clock);
+
+            new_index.push_back(index);
+            keep_index.push_back(index);
+            setTcrState(index, TCR_RUNN);
+
+            Tracking& cur_tcr = tcrAt(index);
+
+            if(entry != INVALID_INDEX){
+
+                int id;
+                KCFTracker* p_kcf = _gallery.take(entry, id);
+
+                recycleKCF(cur_tcr.detachKCF());
+                cur_tcr.revive(id, p_kcf, fd_roi);
+            }
+            else{
+
+                /* Archived trackers gave their KCF tracker away. */
+                if(!cur_tcr.hasKCF()){
+                    cur_tcr.attachKCF(acquireKCF());
+                }
+
+                cur_tcr.restart(frame, fd_roi, _cfg);
+                cur_tcr.setId(_next_id ++);
+            }
+
+            _soa.sync(index, tcrAt(index));
         }
     }
 
@@ -92,17 +180,185 @@ bool objTrack::tick(Mat& frame, vector<fdObject> fd_objs){
     //     }
     // }
 
-    for(int i = 0; i < max_tcr; ++ i){
+    for(int row = 0; row < (int)tcr_index.size(); ++ row){
+
+        int index = tcr_index[row];
+
+        if(IS_SAME_STATE(tcrAt(index).state, TCR_RUNN) && (row_matched[row] == false) &&
+            std::find(new_index.begin(), new_index.end(), index) == new_index.end()){
+
+                setTcrState(index, TCR_LOST_3);
+                tcrAt(index)._lost_clock = _clock;
+        }
+    }
+
+    return true;
+
+}
+
+/**
+ * @brief Decide how every running tracker is updated in this frame, within the time budget.
+ * 
+ * The cost of each tracker is estimated from its template size and scale mode, and turned into 
+ * time using the measured time per cost unit. Trackers with lower score get a full update first, 
+ * since they need it most. Confident trackers fall back to a translation-only update, or are 
+ * deferred when the budget is used up.
+ * 
+ * A tracker already deferred `_max_defer - 1` times is always updated, even over budget. 
+ * So every tracker is updated within `_max_defer` frames.
+ *
+ * @param tcr_index Index of every running tracker. This is the result of this function.
+ * @param modes     Update mode of each tracker in `tcr_index`, `TCR_UPD_FULL`, `TCR_UPD_TRANS` 
+ *                  or `TCR_UPD_DEFER`. This is the result of this function.
+ * 
+ * @return Boolean value. Return `true` if the scheduling goes on properly. 
+ * 
+ */
+bool objTrack::scheduleUpdates(vector<int>& tcr_index, vector<char>& modes){
+
+    tcr_index = listIndex(_runn_tcrs);
+
+    const int n = tcr_index.size();
+    modes.assign(n, TCR_UPD_DEFER);
+
+    /* No measurement yet, update all of them fully to calibrate. */
+    if(_ms_per_cost <= 0.0f){
+
+        modes.assign(n, TCR_UPD_FULL);
+        return true;
+    }
+
+    const int must_update = _max_defer - 1;
+
+    vector<int> order(n);
+    for(int i = 0; i < n; ++ i){
+        order[i] = i;
+    }
+
+    /* Overdue trackers first, then from the lowest score to the highest. */
+    std::sort(order.begin(), order.end(), [&](int a, int b){
 
-        char& state = _p_tcrs[i].state;
+        const Tracking& tcr_a = tcrAt(tcr_index[a]);
+        const Tracking& tcr_b = tcrAt(tcr_index[b]);
 
-        if(IS_SAME_STATE(state, TCR_RUNN) && (tcr_matched[i] == false)){
-                state = TCR_LOST_3;
+        bool overdue_a = tcr_a.getDeferred() >= must_update;
+        bool overdue_b = tcr_b.getDeferred() >= must_update;
+
+        if(overdue_a != overdue_b){
+            return overdue_a;
+        }
+        return tcr_a.getScore() < tcr_b.getScore();
+    });
+
+    float budget_left = _budget_ms;
+
+    for(int i: order){
+
+        Tracking& cur_tcr = tcrAt(tcr_index[i]);
+
+        float full_ms = cur_tcr.getUpdateCost(true) * _ms_per_cost;
+        float trans_ms = cur_tcr.getUpdateCost(false) * _ms_per_cost;
+
+        if(full_ms <= budget_left){
+
+            modes[i] = TCR_UPD_FULL;
+            budget_left -= full_ms;
+        }
+        else if(trans_ms <= budget_left || cur_tcr.getDeferred() >= must_update){
+
+            modes[i] = TCR_UPD_TRANS;
+            budget_left -= trans_ms;
         }
     }
 
     return true;
+}
+
+/**
+ * @brief Update trackers and refine the measured time per cost unit.
+ *
+ * Trackers are updated through the parallel-for set by `setParallelFor`, if any. Each update 
+ * is timed in CPU time of its own thread, so the measured cost doesn't depend on how many 
+ * updates ran side by side or were preempted. Measurements and the structure-of-arrays mirror 
+ * are folded in afterwards in order, so results don't depend on how the updates were run.
+ * 
+ * @param tcr_index Indices of the trackers.
+ * @param modes     Update mode of each tracker. `TCR_UPD_DEFER` ones are skipped.
+ * @param frame     A single frame image input.
+ * 
+ * @return Boolean value. Return `true` if all the updates go on properly. 
+ * 
+ */
+bool objTrack::timedUpdates(const vector<int>& tcr_index, const vector<char>& modes, const Mat& frame){
+
+    const int n = tcr_index.size();
+
+    vector<float> elapsed_ms(n, 0.0f);
+    vector<char> res(n, true);
+
+    auto body = [&](int i){
+
+        if(modes[i] == TCR_UPD_DEFER){
+            return;
+        }
+
+        double start = threadMs();
+        res[i] = tcrAt(tcr_index[i]).update(frame, modes[i] == TCR_UPD_FULL);
+        elapsed_ms[i] = (float)(threadMs() - start);
+    };
+
+    if(_parallel_for && n > 1){
+        _parallel_for(n, body);
+    }
+    else{
+        for(int i = 0; i < n; ++ i){
+            body(i);
+        }
+    }
+
+    bool all_res = true;
+
+    for(int i = 0; i < n; ++ i){
+
+        if(modes[i] == TCR_UPD_DEFER){
+            continue;
+        }
+
+        Tracking& tcr = tcrAt(tcr_index[i]);
+        float cost = tcr.getUpdateCost(modes[i] == TCR_UPD_FULL);
+
+        if(cost > 0.0f){
+
+            float ms_per_cost = elapsed_ms[i] / cost;
+
+            if(_ms_per_cost <= 0.0f){
+                _ms_per_cost = ms_per_cost;
+            }
+            else{
+                _ms_per_cost = (1.0f - _alpha_cost) * _ms_per_cost + _alpha_cost * ms_per_cost;
+            }
+        }
+
+        _soa.sync(tcr_index[i], tcr);
+        all_res = all_res && res[i];
+    }
+
+    return all_res;
+}
 
+/**
+ * @brief Set how tracker updates are run, e.g. on a worker pool shared by several streams.
+ *
+ * @param parallel_for  Runs the updates of a frame. An empty one runs them one after another.
+ * 
+ * @return Boolean value. Return `true` if the setting goes on properly. 
+ * 
+ */
+bool objTrack::setParallelFor(parallelForFn parallel_for){
+
+    _parallel_for = parallel_for;
+
+    return true;
 }
 
 /**
@@ -112,7 +368,8 @@ bool objTrack::tick(Mat& frame, vector<fdObject> fd_objs){
  *
  * @param frame     A single frame image input.
  * @param fd_objs   Detected objects.
- * @param cost      Cost matrix. This is the result of this function.
+ * @param cost      Cost matrix. This is the result of this function. 
+ *                  Row `i` is the tracker at position `i` of the structure-of-arrays mirror.
  * 
  * @return Boolean value. Return `true` if the calculation goes on properly. 
  * 
@@ -120,15 +377,23 @@ bool objTrack::tick(Mat& frame, vector<fdObject> fd_objs){
 bool objTrack::getCostMatrix(const Mat& frame, const vector<fdObject>& fd_objs, Mat& cost){
 
     const int n = fd_objs.size();
-    cost = std::move( Mat(Size(n, max_tcr), CV_32FC1, cv::Scalar(1.0f)));
+    const int m = _soa.size();
+    cost = std::move( Mat(Size(n, m), CV_32FC1, cv::Scalar(1.0f)));
 
-    /* Get features of all detected objects. */
-    vector<Mat> fd_features(n);
+    /* Get features of all detected objects. Pack their bounding boxes like trackers'. */
+    vector<Mat>& fd_features = _fd_features;
+    fd_features.resize(n);
+    vector<float> fd_x(n), fd_y(n), fd_w(n), fd_h(n);
 
     for (int i = 0; i < n; ++ i){
 
         Rect fd_roi = fd_objs[i].resultRect();
 
+        fd_x[i] = fd_roi.x;
+        fd_y[i] = fd_roi.y;
+        fd_w[i] = fd_roi.width;
+        fd_h[i] = fd_roi.height;
+
         fd_features[i] = getFeature(fd_roi, frame);
 
         /* `reduce` is faster and more accurate than `normalize`. */
@@ -138,33 +403,31 @@ bool objTrack::getCostMatrix(const Mat& frame, const vector<fdObject>& fd_objs,
 
 
     /* Get features of all trackers. */
-    vector<Mat> tcr_features(max_tcr);
-
-    for (int i = 0; i < max_tcr; ++ i){
+    vector<Mat> tcr_features(m);
 
-        const char& state = _p_tcrs[i].state;
+    for (int i = 0; i < m; ++ i){
 
-        if(IS_SAME_STATE(state, TCR_RUNN) || IS_SAME_STATE(state, TCR_LOST)){
-            
-            tcr_features[i] = _p_tcrs[i].getAppearance();
+        tcr_features[i] = tcrAt(_soa.tcr_index[i]).getAppearance();
 
-            /* `reduce` is faster and more accurate than `normalize`. */
-            cv::reduce(tcr_features[i] , tcr_features[i] , 1, cv::REDUCE_AVG);
-        }
+        /* `reduce` is faster and more accurate than `normalize`. */
+        cv::reduce(tcr_features[i] , tcr_features[i] , 1, cv::REDUCE_AVG);
 
     }
 
 
-    /* Calculate costs. */
-    for(int y = 0; y < max_tcr; ++ y){
+    /* Get IoU values of all pairs at once. */
+    Mat iou_mat(Size(n, m), CV_32FC1);
 
-        Tracking& cur_tcr = _p_tcrs[y];
+    const boxArrays tcr_boxes = {_soa.x.data(), _soa.y.data(), _soa.w.data(), _soa.h.data(), m};
+    const boxArrays fd_boxes = {fd_x.data(), fd_y.data(), fd_w.data(), fd_h.data(), n};
 
-        char& state = cur_tcr.state;
+    func::IoUMatrix(tcr_boxes, fd_boxes, iou_mat.ptr<float>(0), iou_mat.step1());
 
-        if(!(IS_SAME_STATE(state, TCR_RUNN) || IS_SAME_STATE(state, TCR_LOST))){
-            continue;
-        }
+
+    /* Calculate costs. */
+    vector<float> appearance_score(n);
+
+    for(int y = 0; y < m; ++ y){
 
         /* Exmpt newly lost tracker. */
         // if(IS_SUB_STATE(state, TCR_LOST)){
@@ -173,42 +436,31 @@ bool objTrack::getCostMatrix(const Mat& frame, const vector<fdObject>& fd_objs,
         //     continue;
         // }
 
-        for(int x = 0; x < n; ++ x){
-
-            /* Get IoU value. */
-            float iou;
-
-            /* IoU is meaning-less for a lost tracker. */
-            if(IS_SAME_STATE(state, TCR_RUNN)){
-                Rect kcf_roi = cur_tcr.getROI();
-                Rect fd_roi = fd_objs[x].resultRect();
+        float* iou = iou_mat.ptr<float>(y);
 
-                iou = func::IoU(kcf_roi, fd_roi);
-                
-            }
-            else{
-                iou = 0.0f;
-            }
-            
+        /* IoU is meaning-less for a lost tracker. */
+        if(!IS_SAME_STATE(_soa.state[y], TCR_RUNN)){
+            std::fill(iou, iou + n, 0.0f);
+        }
 
-            /* Get feature similarity using Gaussian Kernel Function. */
-            float appearance_score = 0.0f;
+        /* Get feature similarity using Gaussian Kernel Function. */
+        for(int x = 0; x < n; ++ x){
             
             /* Gaussian Kernel Funciton. */
             float sigma = 0.05f;
             Mat diff = fd_features[x] - tcr_features[y];
-            appearance_score = std::exp(- diff.dot(diff) / (2 * sigma * sigma));
+            appearance_score[x] = std::exp(- diff.dot(diff) / (2 * sigma * sigma));
 
-            // appearance_score = 0.0f;
+            // std::cout << "norm² = " << diff.dot(diff)  << " score = " << appearance_score[x] << std::endl;
+        }
 
-            // std::cout << "norm² = " << diff.dot(diff)  << " score = " << appearance_score << std::endl;
+        float* p_cost = cost.ptr<float>(y);
 
-            cost.at<float>(y,x) = 0.5f * (1.0f - iou) + 0.5f * (1.0f - appearance_score);
- 
+        for(int x = 0; x < n; ++ x){
 
-            // cout << "Ap: " << appearance_score << endl << "IoU: " << iou << endl << endl; 
-            // cout << "Ct: " << cost.at<float>(y,x) <<endl<<endl;
+            p_cost[x] = 0.5f * (1.0f - iou[x]) + 0.5f * (1.0f - appearance_score[x]);
         }
+
         // cout<< "--- --- ---" <<endl << endl;
     }
 
@@ -220,30 +472,24 @@ bool objTrack::getCostMatrix(const Mat& frame, const vector<fdObject>& fd_objs,
  *
  * @param fd_objs           Detected objects.
  * @param cost              Cost matrix we calculated.
- * @param matched_tcr_index Index of the successfully matched trackers. 
+ * @param matched_tcr_row   Row in `cost` of the successfully matched trackers. 
  *                          This is the result of this function.
  * 
  * @return Boolean value. Return `true` if the match goes on properly. 
  * 
  */
-bool objTrack::hungarianMatch(const vector<fdObject>& fd_objs, const Mat& cost, vector<int>& matched_tcr_index){
+bool objTrack::hungarianMatch(const vector<fdObject>& fd_objs, const Mat& cost, vector<int>& matched_tcr_row){
     int n = fd_objs.size();
+    int m = cost.rows;
 
     /* Variable length array is not allowed, use `vector` instead. */
-    vector<bool> tcr_used(max_tcr, false );
+    vector<bool> tcr_used(m, false );
     vector<bool> obj_used(n, false);
 
-    /* Point every detected objects to none tracker index (-1). */
-    matched_tcr_index.resize(n);
+    /* Point every detected objects to none tracker row (-1). */
+    matched_tcr_row.resize(n);
     for(int i = 0; i < n; ++ i){
-        matched_tcr_index[i] = INVALID_INDEX;
-    }
-
-    for(int i = 0; i < max_tcr; ++ i){
-        const char& state = _p_tcrs[i].state;
-        if(!(IS_SAME_STATE(state, TCR_RUNN) || IS_SAME_STATE(state, TCR_LOST))){
-            tcr_used[i] = true;
-        }
+        matched_tcr_row[i] = INVALID_INDEX;
     }
 
 
@@ -254,8 +500,8 @@ bool objTrack::hungarianMatch(const vector<fdObject>& fd_objs, const Mat& cost,
         int best_x = -1;
         int best_y = -1;
 
-        for(int y = 0; y < max_tcr; ++ y){
-            /* Skip paired or uninitiated trackers. */
+        for(int y = 0; y < m; ++ y){
+            /* Skip paired trackers. */
             if(tcr_used[y]) continue;
 
             for(int x = 0; x < n; ++ x){
@@ -274,7 +520,7 @@ bool objTrack::hungarianMatch(const vector<fdObject>& fd_objs, const Mat& cost,
 
         if(best_x == -1 || best_y == -1) break;
 
-        matched_tcr_index[best_x] = best_y;
+        matched_tcr_row[best_x] = best_y;
 
         tcr_used[best_y] = true;
         obj_used[best_x] = true;
@@ -287,195 +533,647 @@ bool objTrack::hungarianMatch(const vector<fdObject>& fd_objs, const Mat& cost,
 
 
 /**
- * @brief Get the index of a free KCF tracker. 
- * 
- * A maximum number of trackers is enforced to control overall resource usage.
+ * @brief Move a lost track into the re-identification gallery, before its tracker is taken over.
  * 
- * If all tracker are busy, schduling, based on tracking quality, will be performed.
+ * The gallery takes the KCF tracker, so the model can be reused when the object comes back.
  *
- * @param void void.
+ * @param index     Index of the lost tracker.
  * 
- * @return The index of a free tracker.
+ * @return Boolean value. Return `true` if the archiving goes on properly. 
  * 
  */
-int objTrack::getFreeTcrIndex(void){
-
-    /* Return the index of Tracker with minimum score. */
+bool objTrack::archiveTcr(int index){
 
-    /* If there's free tracker. */
-    for(int i = 0;i < max_tcr; ++ i){  
-
-        if(IS_SAME_STATE(_p_tcrs[i].state, TCR_READY)){
-            return i;
-        }
-    }
-
-    /* No free tracker. Get a lost tracker. */
-    for(int i = 0;i < max_tcr; ++ i){
+    Tracking& tcr = tcrAt(index);
 
-        if(IS_SAME_STATE(_p_tcrs[i].state, TCR_LOST)){
-            return i;
-        }
+    Mat desc = tcr.getAppearance();
+    if(desc.empty()){
+        return false;
     }
 
-    /* All trackers are tracking. Find the tracker with lowest score. */
-    int index = 0;
-    float score_min = _p_tcrs[0].getScore();
-    float score;
+    /* Same descriptor as the cost matrix uses. */
+    cv::reduce(desc, desc, 1, cv::REDUCE_AVG);
 
-    for(int i = 1; i < max_tcr; ++ i){
-        score = _p_tcrs[i].getScore();
-        if(score < score_min){
-            score_min = score;
-            index = i;
-        }
-    }
+    KCFTracker* p_kcf = _gallery.push(tcr.getId(), desc, tcr.getROI(), tcr.getVelocity(), 
+                                        tcr._lost_clock, tcr.detachKCF());
+    recycleKCF(p_kcf);
 
-    return index;
+    return true;
 }
 
 /**
- * @brief Extract the features of region of interest exactly in the same way as tracker.
- * 
+ * @brief Apply the KCF settings of the configuration to a new KCF tracker, before its `init`.
  *
- * @param roi       Bounding box of the region of interest.
- * @param frame     A single frame image input.
+ * @param p_kcf     The KCF tracker.
  * 
- * @return Boolean value. Return `true` if the calculation goes on properly. 
+ * @return Boolean value. Return `true` if the setting goes on properly. 
  * 
  */
-Mat objTrack::getFeature(const Rect roi, const Mat& frame){
-    bool hog = true, fixed_window = true;
-    bool multiscale = true, lab = true;
+bool objTrack::configureKCF(KCFTracker* p_kcf) const{
 
-    static KCFTracker tmp_kcf(hog, fixed_window, multiscale, lab);
-    Mat appearance;
-
-    tmp_kcf.getRoiFeature(roi, frame, appearance);
-
-    return appearance;
+    return _cfg.configureKCF(p_kcf);
 }
 
 /**
- * @brief Get all the bounding boxes currently tracking.
+ * @brief Check the settings, before a Tracking is built with them.
  *
- * Encapsulation protects class data by using functions for access, 
- * preventing accidental changes.
+ * @param void void.
  * 
- * @return Bounding boxes currently tracking.
+ * @return void. Throws `std::runtime_error` if a setting is out of range.
  * 
  */
-vector<Rect> objTrack::getROIs(void) const{
-
-    vector<Rect> res;
+void trackConfig::validate(void) const{
 
-    for(int i = 0; i < max_tcr; ++ i){
+    if(max_tcr < 1){
 
-        if(IS_SAME_STATE(_p_tcrs[i].state, TCR_RUNN)){
-            res.push_back( _p_tcrs[i].getROI());
-        }
+        throw std::runtime_error("ERR:Max trackers must be positive");
     }
 
-    return res;
-}
+    if(budget_ms <= 0.0f){
 
-/**
- * @brief Update all the trackers with an new single frame of image.
- * 
- * And paint Detection and Tracking results on the image.
- *
- * @param frame     A single frame image input.
- * 
- * @return Boolean value. Return `true` if the updating goes on properly. 
- * 
- */
-bool Tracking::update(Mat& frame){
+        throw std::runtime_error("ERR:Update budget must be positive");
+    }
 
-    Rect bbox;
-    bbox = _p_kcf -> update(frame, _beta_1, _beta_2, _alpha_apce, _peak_value, _mean_peak_value, 
-                            _mean_apce_value, _current_apce_value, _apce_accepted);
-    _roi = bbox;
+    if(max_defer < 1){
 
-    if(_apce_accepted){
-        /* Bonus for accepted trackers. */
-        _score = 1000.0f + _current_apce_value + _peak_value;
+        throw std::runtime_error("ERR:Max defer must be positive");
     }
-    else{
-        _score = 0.0f + _current_apce_value + _peak_value;
+
+    if(kcf_model_precision != QMAT_FLOAT32 && kcf_model_precision != QMAT_FLOAT16 
+        && kcf_model_precision != QMAT_INT8){
+
+        throw std::runtime_error("ERR:Unknown KCF model precision");
     }
 
-    char title[6];
-    snprintf(title, sizeof(title), "id:%02d", _id);
+    /* Zero keeps the KCF default. */
+    if(kcf_template_size < 0 || kcf_cell_size < 0 || kcf_padding < 0.0f){
+
+        throw std::runtime_error("ERR:KCF sizes must not be negative");
+    }
 
-    char apce_datas[23];
-    snprintf(apce_datas, sizeof(apce_datas), "APCE: %04.1f / %04.1f %c",
-                _current_apce_value, _mean_apce_value, _apce_accepted? 'T' : 'F');
+    if(kcf_interp_factor < 0.0f || kcf_interp_factor > 1.0f){
 
-    char peak_datas[20];
-    snprintf(peak_datas, sizeof(peak_datas), "Peak: %04.1f / %04.1f",
-                _peak_value * 100, _mean_peak_value * 100);
+        throw std::runtime_error("ERR:KCF interpolation factor must be within [0, 1]");
+    }
 
-    cv::putText(frame, title, cv::Point(bbox.x, bbox.y - 1),cv::FONT_HERSHEY_SIMPLEX,
-                         0.5, cv::Scalar(0,0,255), 1, cv::LINE_AA);
-    cv::putText(frame, apce_datas, cv::Point(bbox.x,bbox.y + bbox.height + 13),cv::FONT_HERSHEY_SIMPLEX,
-                         0.3, cv::Scalar(0,255,0), 1, cv::LINE_AA);
-    cv::putText(frame, peak_datas, cv::Point(bbox.x,bbox.y + bbox.height + 13 * 2),cv::FONT_HERSHEY_SIMPLEX,
-                         0.3, cv::Scalar(0,255,0), 1, cv::LINE_AA);
-    cv::rectangle(frame,bbox, cv::Scalar(0,0,255));
+    if(kcf_train_max_skip < 0){
 
-    return true;
+        throw std::runtime_error("ERR:KCF max skip must not be negative");
+    }
 }
 
 /**
- * @brief Start or restart a tracking process with an new tracker.
- *
- * Initializes a new tracker with the given parameters and sets the tracker's state.
+ * @brief Apply the KCF settings to a new KCF tracker, before its `init`. Every KCF tracker 
+ *        of a Tracking goes through it, so they are all configured the same way.
  *
- * @param first_f       The initial frame used for tracker initialization.
- * @param roi           Bounding box of the region of interest to track.
- * @param _state        Initial state assigned to the tracker. Default value is `TCR_RUNN`.
- * @param hog           Whether to use HOG features. Default value is `true`.
- * @param fixed_window  Whether to use a fixed window size. Default value is `true`.
- * @param multiscale    Whether to enable multi-scale tracking. Default value is `true`.
- * @param lab           Whether to include Lab color features. Default value is `true`.
+ * @param p_kcf     The KCF tracker.
  * 
- * @return Boolean value. Return `true` if the initialization goes on properly. 
+ * @return Boolean value. Return `true` if the setting goes on properly. 
  * 
  */
-bool Tracking::restart(Mat first_f, Rect roi, char _state, bool hog, 
-    bool fixed_window, bool multiscale, bool lab){
+bool trackConfig::configureKCF(KCFTracker* p_kcf) const{
 
-    _roi = roi;
-    state = _state;
-    if(_p_kcf != nullptr) delete _p_kcf;
-    _p_kcf = new KCFTracker(hog, fixed_window, multiscale, lab);
-    _p_kcf -> init(roi, first_f);
+    if(p_kcf == nullptr){
+        return false;
+    }
+
+    p_kcf -> model_precision = kcf_model_precision;
+    p_kcf -> train_similarity = kcf_train_similarity;
+    p_kcf -> train_max_skip = kcf_train_max_skip;
+
+    if(kcf_template_size > 0){
+        p_kcf -> template_size = kcf_template_size;
+    }
+    if(kcf_cell_size > 0){
+        p_kcf -> cell_size = kcf_cell_size;
+        p_kcf -> cell_sizeQ = kcf_cell_size * kcf_cell_size;
+    }
+    if(kcf_padding > 0.0f){
+        p_kcf -> padding = kcf_padding;
+    }
+    if(kcf_interp_factor > 0.0f){
+        p_kcf -> interp_factor = kcf_interp_factor;
+    }
 
     return true;
 }
 
 /**
- * @brief Get the tracking quality score of KCF tracker.
+ * @brief Get an idle KCF tracker from the pool, or a new one if the pool is empty.
  *
- * Encapsulation protects class data by using functions for access, 
- * preventing accidental changes.
+ * Pooled trackers are re-initialized by `Tracking::restart`, reusing their buffers.
  * 
  * @param void void.
  * 
- * @return The tracking quality score of KCF tracker.
+ * @return The KCF tracker. The caller takes its ownership.
  * 
  */
-float Tracking::getScore(void) const{
-    return _score;
+KCFTracker* objTrack::acquireKCF(void){
+
+    if(!_p_kcf_pool.empty()){
+
+        KCFTracker* p_kcf = _p_kcf_pool.back();
+        _p_kcf_pool.pop_back();
+
+        return p_kcf;
+    }
+
+    bool hog = true, fixed_window = true;
+    bool multiscale = true, lab = true;
+
+    KCFTracker* p_kcf = new KCFTracker(hog, fixed_window, multiscale, lab, KCF_LINEAR_KERNEL);
+    configureKCF(p_kcf);
+
+    return p_kcf;
 }
 
 /**
- * @brief Get the bounding box of a tracked object.
+ * @brief Return a KCF tracker no longer used by any track to the pool.
  *
- * Encapsulation protects class data by using functions for access, 
- * preventing accidental changes.
+ * It's deleted if the pool is full.
  * 
- * @return The bounding box of a tracked object.
+ * @param p_kcf     The KCF tracker. Nothing happens if it's `nullptr`.
+ * 
+ * @return Boolean value. Return `true` if the recycling goes on properly. 
+ * 
+ */
+bool objTrack::recycleKCF(KCFTracker* p_kcf){
+
+    if(p_kcf == nullptr){
+        return true;
+    }
+
+    if(_p_kcf_pool.size() < KCF_POOL_SIZE){
+        _p_kcf_pool.push_back(p_kcf);
+    }
+    else{
+        delete p_kcf;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the index of a free KCF tracker. 
+ * 
+ * A maximum number of trackers is enforced to control overall resource usage.
+ * Trackers are allocated on demand, the pool grows until the maximum is reached.
+ * 
+ * If all tracker are busy, schduling, based on tracking quality, will be performed.
+ *
+ * @param keep      Trackers never taken over, e.g. the ones matched or started in this frame.
+ * 
+ * @return The index of a free tracker, or `INVALID_INDEX` if only trackers in `keep` are left.
+ * 
+ */
+int objTrack::getFreeTcrIndex(const vector<int>& keep){
+
+    /* If there's free tracker. */
+    if(_free_tcrs.size > 0){
+        return _free_tcrs.head;
+    }
+
+    /* Allocate more free trackers if allowed. */
+    if(_capacity < max_tcr && grow()){
+        return _free_tcrs.head;
+    }
+
+    auto kept = [&](int i){ return std::find(keep.begin(), keep.end(), i) != keep.end(); };
+
+    /* No free tracker. Get the tracker lost for the longest time. */
+    for(int i = _lost_tcrs.head; i != INVALID_INDEX; i = tcrAt(i)._next_index){
+        if(false == kept(i)){
+            return i;
+        }
+    }
+
+    /* All trackers are tracking. Find the tracker with lowest score. */
+    int index = INVALID_INDEX;
+    float score_min = 0.0f;
+    float score;
+
+    for(int i = _runn_tcrs.head; i != INVALID_INDEX; i = tcrAt(i)._next_index){
+
+        if(kept(i)){
+            continue;
+        }
+
+        score = tcrAt(i).getScore();
+        if(index == INVALID_INDEX || score < score_min){
+            score_min = score;
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * @brief Allocate a new chunk of free trackers.
+ *
+ * Trackers of a chunk never move, so references and indices stay valid.
+ * 
+ * @param void void.
+ * 
+ * @return Boolean value. Return `false` if the maximum number of trackers is reached. 
+ * 
+ */
+bool objTrack::grow(void){
+
+    const int n = MIN(TCR_POOL_CHUNK, max_tcr - _capacity);
+
+    if(n <= 0){
+        return false;
+    }
+
+    Tracking* p_chunk = new Tracking[n];
+    _p_chunks.push_back(p_chunk);
+
+    for(int i = 0; i < n; ++ i){
+
+        p_chunk[i] = std::move(Tracking(_capacity + i));
+    }
+
+    /* Chunk must be registered before linking, linking looks trackers up by index. */
+    for(int i = 0; i < n; ++ i){
+        linkTcr(_free_tcrs, _capacity + i);
+    }
+
+    _capacity += n;
+    _soa.reserve(_capacity);
+
+    return true;
+}
+
+/**
+ * @brief Get a tracker by its index.
+ *
+ * @param index     Index of the tracker.
+ * 
+ * @return The tracker.
+ * 
+ */
+Tracking& objTrack::tcrAt(int index){
+
+    return _p_chunks[index / TCR_POOL_CHUNK][index % TCR_POOL_CHUNK];
+}
+
+const Tracking& objTrack::tcrAt(int index) const{
+
+    return _p_chunks[index / TCR_POOL_CHUNK][index % TCR_POOL_CHUNK];
+}
+
+/**
+ * @brief Get the list holding trackers of the given state.
+ *
+ * @param state     State of trackers, sub-states included.
+ * 
+ * @return The list of free, running or lost trackers.
+ * 
+ */
+tcrList& objTrack::listOf(char state){
+
+    if(IS_SAME_STATE(state, TCR_RUNN)){
+        return _runn_tcrs;
+    }
+    else if(IS_SAME_STATE(state, TCR_LOST)){
+        return _lost_tcrs;
+    }
+
+    return _free_tcrs;
+}
+
+/**
+ * @brief Get the indices of all trackers in a list, from head to tail.
+ *
+ * @param list      A list of trackers.
+ * 
+ * @return Indices of the trackers in the list.
+ * 
+ */
+vector<int> objTrack::listIndex(const tcrList& list) const{
+
+    vector<int> res;
+    res.reserve(list.size);
+
+    for(int i = list.head; i != INVALID_INDEX; i = tcrAt(i)._next_index){
+        res.push_back(i);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Change the state of a tracker, and move it to the list of its new state in O(1).
+ *
+ * The tracker is appended to the tail of the list. So the head of a list is the tracker 
+ * staying in that state for the longest time.
+ * 
+ * @param index     Index of the tracker.
+ * @param state     New state of the tracker.
+ * 
+ * @return Boolean value. Return `true` if the change goes on properly. 
+ * 
+ */
+bool objTrack::setTcrState(int index, char state){
+
+    Tracking& tcr = tcrAt(index);
+
+    tcrList& from = listOf(tcr.state);
+    tcrList& to = listOf(state);
+
+    tcr.state = state;
+
+    if(&from != &to){
+
+        unlinkTcr(from, index);
+        linkTcr(to, index);
+
+        /* Only running and lost trackers are mirrored. */
+        if(&from == &_free_tcrs){
+            _soa.add(index);
+        }
+        else if(&to == &_free_tcrs){
+            _soa.remove(index);
+        }
+    }
+
+    if(&to != &_free_tcrs){
+        _soa.sync(index, tcr);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Append a tracker to the tail of a list.
+ *
+ * @param list      The list to append to. The tracker must not be in any list.
+ * @param index     Index of the tracker.
+ * 
+ * @return Boolean value. Return `true` if the linking goes on properly. 
+ * 
+ */
+bool objTrack::linkTcr(tcrList& list, int index){
+
+    Tracking& tcr = tcrAt(index);
+
+    tcr._prev_index = list.tail;
+    tcr._next_index = INVALID_INDEX;
+
+    if(list.tail != INVALID_INDEX){
+        tcrAt(list.tail)._next_index = index;
+    }
+    else{
+        list.head = index;
+    }
+
+    list.tail = index;
+    ++ list.size;
+
+    return true;
+}
+
+/**
+ * @brief Remove a tracker from a list.
+ *
+ * @param list      The list holding the tracker.
+ * @param index     Index of the tracker.
+ * 
+ * @return Boolean value. Return `true` if the unlinking goes on properly. 
+ * 
+ */
+bool objTrack::unlinkTcr(tcrList& list, int index){
+
+    Tracking& tcr = tcrAt(index);
+
+    if(tcr._prev_index != INVALID_INDEX){
+        tcrAt(tcr._prev_index)._next_index = tcr._next_index;
+    }
+    else{
+        list.head = tcr._next_index;
+    }
+
+    if(tcr._next_index != INVALID_INDEX){
+        tcrAt(tcr._next_index)._prev_index = tcr._prev_index;
+    }
+    else{
+        list.tail = tcr._prev_index;
+    }
+
+    tcr._prev_index = INVALID_INDEX;
+    tcr._next_index = INVALID_INDEX;
+    -- list.size;
+
+    return true;
+}
+
+/**
+ * @brief Get the number of trackers allocated so far.
+ *
+ * Encapsulation protects class data by using functions for access, 
+ * preventing accidental changes.
+ * 
+ * @param void void.
+ * 
+ * @return The number of trackers allocated.
+ * 
+ */
+int objTrack::capacity(void) const{
+    return _capacity;
+}
+
+/**
+ * @brief Extract the features of region of interest exactly in the same way as tracker.
+ * 
+ *
+ * @param roi       Bounding box of the region of interest.
+ * @param frame     A single frame image input.
+ * 
+ * @return Boolean value. Return `true` if the calculation goes on properly. 
+ * 
+ */
+Mat objTrack::getFeature(const Rect roi, const Mat& frame){
+    bool hog = true, fixed_window = true;
+    bool multiscale = true, lab = true;
+
+    /* One per `objTrack`, so that streams never share it. */
+    if(_p_feature_kcf == nullptr){
+        _p_feature_kcf = new KCFTracker(hog, fixed_window, multiscale, lab);
+        configureKCF(_p_feature_kcf);
+    }
+    Mat appearance;
+
+    _p_feature_kcf -> getRoiFeature(roi, frame, appearance);
+
+    return appearance;
+}
+
+/**
+ * @brief Get the results of all the running trackers, for drawing or output.
+ *
+ * @param results   Results of the running trackers. This is the result of this function.
+ * 
+ * @return Boolean value. Return `true` if the collection goes on properly. 
+ * 
+ */
+bool objTrack::getResults(vector<tcrResult>& results) const{
+
+    results.clear();
+
+    for(int i = _runn_tcrs.head; i != INVALID_INDEX; i = tcrAt(i)._next_index){
+        results.push_back( tcrAt(i).getResult());
+    }
+
+    return true;
+}
+
+/**
+ * @brief Count the running trackers whose latest response failed the APCE test.
+ *
+ * @return Number of such trackers.
+ * 
+ */
+int objTrack::getWeakCount(void) const{
+
+    int count = 0;
+
+    for(int i = _runn_tcrs.head; i != INVALID_INDEX; i = tcrAt(i)._next_index){
+
+        if(false == tcrAt(i)._apce_accepted){
+            ++ count;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Get all the bounding boxes currently tracking.
+ *
+ * Encapsulation protects class data by using functions for access, 
+ * preventing accidental changes.
+ * 
+ * @return Bounding boxes currently tracking.
+ * 
+ */
+vector<Rect> objTrack::getROIs(void) const{
+
+    vector<Rect> res;
+    res.reserve(_runn_tcrs.size);
+
+    for(int i = _runn_tcrs.head; i != INVALID_INDEX; i = tcrAt(i)._next_index){
+        res.push_back( tcrAt(i).getROI());
+    }
+
+    return res;
+}
+
+/**
+ * @brief Update all the trackers with an new single frame of image.
+ * 
+ * The frame is only read. Results are drawn by the renderer, see `getResult`.
+ *
+ * @param frame     A single frame image input.
+ * @param full      Whether to search scales and train the model. 
+ *                  Otherwise only translation is estimated. Default value is `true`.
+ * 
+ * @return Boolean value. Return `true` if the updating goes on properly. 
+ * 
+ */
+bool Tracking::update(const Mat& frame, bool full){
+
+    Rect bbox;
+    bbox = _p_kcf -> update(frame, _beta_1, _beta_2, _alpha_apce, _peak_value, _mean_peak_value, 
+                            _mean_apce_value, _current_apce_value, _apce_accepted, full);
+
+    /* Center shift per frame, frames skipped by the scheduler included. */
+    cv::Point2f shift((bbox.x + bbox.width / 2.0f) - (_roi.x + _roi.width / 2.0f),
+                      (bbox.y + bbox.height / 2.0f) - (_roi.y + _roi.height / 2.0f));
+    shift *= 1.0f / (_deferred + 1);
+    _velocity = (1.0f - _alpha_velocity) * _velocity + _alpha_velocity * shift;
+
+    _roi = bbox;
+    _deferred = 0;
+    _response = _p_kcf -> getResponseStats();
+
+    if(_apce_accepted){
+        /* Bonus for accepted trackers. */
+        _score = 1000.0f + _current_apce_value + _peak_value;
+    }
+    else{
+        _score = 0.0f + _current_apce_value + _peak_value;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Start or restart a tracking process with an new tracker.
+ *
+ * Initializes a new tracker with the given parameters and sets the tracker's state.
+ * The current KCF tracker is re-initialized in place when it has the same configuration.
+ *
+ * @param first_f       The initial frame used for tracker initialization.
+ * @param roi           Bounding box of the region of interest to track.
+ * @param cfg           Runtime settings a new KCF tracker is configured with.
+ * @param _state        Initial state assigned to the tracker. Default value is `TCR_RUNN`.
+ * @param hog           Whether to use HOG features. Default value is `true`.
+ * @param fixed_window  Whether to use a fixed window size. Default value is `true`.
+ * @param multiscale    Whether to enable multi-scale tracking. Default value is `true`.
+ * @param lab           Whether to include Lab color features. Default value is `true`.
+ * @param linear        Whether to use a linear kernel instead of a Gaussian one. Default value is `KCF_LINEAR_KERNEL`.
+ * 
+ * @return Boolean value. Return `true` if the initialization goes on properly. 
+ * 
+ */
+bool Tracking::restart(Mat first_f, Rect roi, const trackConfig& cfg, char _state, bool hog, 
+    bool fixed_window, bool multiscale, bool lab, bool linear){
+
+    _roi = roi;
+    state = _state;
+    _deferred = 0;
+    _velocity = cv::Point2f(0.0f, 0.0f);
+    _response = KCFKernels::responseStats();
+
+    /* Re-initialize the current KCF tracker to reuse its buffers, if it's configured the same way. */
+    if(_p_kcf != nullptr && _p_kcf -> isConfigured(hog, fixed_window, multiscale, lab, linear)){
+
+        _p_kcf -> reinit(roi, first_f);
+    }
+    else{
+
+        if(_p_kcf != nullptr) delete _p_kcf;
+        _p_kcf = new KCFTracker(hog, fixed_window, multiscale, lab, linear);
+        cfg.configureKCF(_p_kcf);
+        _p_kcf -> init(roi, first_f);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the tracking quality score of KCF tracker.
+ *
+ * Encapsulation protects class data by using functions for access, 
+ * preventing accidental changes.
+ * 
+ * @param void void.
+ * 
+ * @return The tracking quality score of KCF tracker.
+ * 
+ */
+float Tracking::getScore(void) const{
+    return _score;
+}
+
+/**
+ * @brief Get the bounding box of a tracked object.
+ *
+ * Encapsulation protects class data by using functions for access, 
+ * preventing accidental changes.
+ * 
+ * @return The bounding box of a tracked object.
  * 
  */
 Rect Tracking::getROI(void) const{
@@ -496,6 +1194,11 @@ Rect Tracking::getROI(void) const{
  * 
  */
 Mat Tracking::getAppearance(void) const{
+
+    if(_p_kcf == nullptr){
+        return Mat();
+    }
+
     /* Return the features KCF tracker is using. */
     return _p_kcf -> getTmpl();
 }
@@ -529,3 +1232,362 @@ float Tracking::getApce(void) const{
 float Tracking::getPeak(void) const{
     return _peak_value;
 }
+
+/**
+ * @brief Get the Peak-to-Sidelobe Ratio (PSR) of KCF response map.
+ *
+ * @param void void.
+ * 
+ * @return PSR of the latest response map.
+ * 
+ */
+float Tracking::getPSR(void) const{
+    return _response.psr;
+}
+
+/**
+ * @brief Get all statistics of KCF response map, computed along with APCE at no extra cost.
+ *
+ * @param void void.
+ * 
+ * @return Peak and minimum with their locations, APCE, PSR and second peak ratio of the latest response map.
+ * 
+ */
+const KCFKernels::responseStats& Tracking::getResponse(void) const{
+    return _response;
+}
+
+/**
+ * @brief Skip the update of this frame. The scheduler had no budget left for it.
+ *
+ * @param void void.
+ * 
+ * @return Boolean value. Return `true` if the skipping goes on properly. 
+ * 
+ */
+bool Tracking::defer(void){
+
+    ++ _deferred;
+
+    return true;
+}
+
+/**
+ * @brief Get the number of frames skipped since the last update.
+ *
+ * Encapsulation protects class data by using functions for access, 
+ * preventing accidental changes.
+ * 
+ * @param void void.
+ * 
+ * @return The number of frames skipped since the last update.
+ * 
+ */
+int Tracking::getDeferred(void) const{
+    return _deferred;
+}
+
+/**
+ * @brief Get the estimated cost of updating the KCF tracker.
+ *
+ * @param full      Whether it's a full update or a translation-only update.
+ * 
+ * @return The estimated cost. Zero if there's no KCF tracker.
+ * 
+ */
+float Tracking::getUpdateCost(bool full) const{
+
+    if(_p_kcf == nullptr){
+        return 0.0f;
+    }
+
+    return _p_kcf -> getUpdateCost(full);
+}
+
+/**
+ * @brief Start mirroring a tracker. It's appended to the end of the arrays.
+ *
+ * @param index     Index of the tracker.
+ * 
+ * @return Boolean value. Return `false` if it's already mirrored. 
+ * 
+ */
+bool tcrSoA::add(int index){
+
+    if(_pos[index] != INVALID_INDEX){
+        return false;
+    }
+
+    _pos[index] = tcr_index.size();
+
+    tcr_index.push_back(index);
+    x.push_back(0.0f);
+    y.push_back(0.0f);
+    w.push_back(0.0f);
+    h.push_back(0.0f);
+    state.push_back(TCR_READY);
+    score.push_back(0.0f);
+    apce.push_back(0.0f);
+    peak.push_back(0.0f);
+    psr.push_back(0.0f);
+
+    return true;
+}
+
+/**
+ * @brief Stop mirroring a tracker. The last tracker is moved to its position, in O(1).
+ *
+ * @param index     Index of the tracker.
+ * 
+ * @return Boolean value. Return `false` if it's not mirrored. 
+ * 
+ */
+bool tcrSoA::remove(int index){
+
+    const int pos = _pos[index];
+
+    if(pos == INVALID_INDEX){
+        return false;
+    }
+
+    const int last = tcr_index.size() - 1;
+
+    tcr_index[pos] = tcr_index[last];
+    x[pos] = x[last];
+    y[pos] = y[last];
+    w[pos] = w[last];
+    h[pos] = h[last];
+    state[pos] = state[last];
+    score[pos] = score[last];
+    apce[pos] = apce[last];
+    peak[pos] = peak[last];
+    psr[pos] = psr[last];
+
+    _pos[tcr_index[pos]] = pos;
+    _pos[index] = INVALID_INDEX;
+
+    tcr_index.pop_back();
+    x.pop_back();
+    y.pop_back();
+    w.pop_back();
+    h.pop_back();
+    state.pop_back();
+    score.pop_back();
+    apce.pop_back();
+    peak.pop_back();
+    psr.pop_back();
+
+    return true;
+}
+
+/**
+ * @brief Copy the current state of a tracker into the arrays.
+ *
+ * @param index     Index of the tracker.
+ * @param tcr       The tracker.
+ * 
+ * @return Boolean value. Return `false` if it's not mirrored. 
+ * 
+ */
+bool tcrSoA::sync(int index, const Tracking& tcr){
+
+    const int pos = _pos[index];
+
+    if(pos == INVALID_INDEX){
+        return false;
+    }
+
+    Rect roi = tcr.getROI();
+
+    x[pos] = roi.x;
+    y[pos] = roi.y;
+    w[pos] = roi.width;
+    h[pos] = roi.height;
+    state[pos] = tcr.state;
+    score[pos] = tcr.getScore();
+    apce[pos] = tcr.getApce();
+    peak[pos] = tcr.getPeak();
+    psr[pos] = tcr.getPSR();
+
+    return true;
+}
+
+/**
+ * @brief Make room for trackers with index lower than `capacity`.
+ *
+ * @param capacity  Number of trackers allocated.
+ * 
+ * @return Boolean value. Return `true` if the reservation goes on properly. 
+ * 
+ */
+bool tcrSoA::reserve(int capacity){
+
+    if((int)_pos.size() < capacity){
+        _pos.resize(capacity, INVALID_INDEX);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the number of mirrored trackers.
+ *
+ * @param void void.
+ * 
+ * @return The number of mirrored trackers.
+ * 
+ */
+int tcrSoA::size(void) const{
+    return tcr_index.size();
+}
+
+/**
+ * @brief Get the position of a tracker in the arrays.
+ *
+ * @param index     Index of the tracker.
+ * 
+ * @return The position, or `INVALID_INDEX` if it's not mirrored.
+ * 
+ */
+int tcrSoA::posOf(int index) const{
+    return _pos[index];
+}
+
+/**
+ * @brief Revive a lost track with its stored KCF tracker, at the position of a detected object.
+ *
+ * The trained model and scale of the KCF tracker are kept, so no initialization or training is needed.
+ * 
+ * @param id        ID of the lost track.
+ * @param p_kcf     KCF tracker of the lost track. The tracker takes the ownership.
+ * @param roi       Bounding box of the detected object.
+ * 
+ * @return Boolean value. Return `true` if the revival goes on properly. 
+ * 
+ */
+bool Tracking::revive(int id, KCFTracker* p_kcf, Rect roi){
+
+    if(_p_kcf != nullptr) delete _p_kcf;
+    _p_kcf = p_kcf;
+    _p_kcf -> relocate(roi);
+
+    _id = id;
+    _roi = roi;
+    state = TCR_RUNN;
+    _deferred = 0;
+    _velocity = cv::Point2f(0.0f, 0.0f);
+
+    /* Quality statistics restart from scratch, none of the previous occupant's are kept. */
+    _score = 0.0f;
+    _peak_value = 0.0f;
+    _current_apce_value = 0.0f;
+    _mean_apce_value = 0.0f;
+    _mean_peak_value = 0.0f;
+    _apce_accepted = true;
+    _response = KCFKernels::responseStats();
+
+    return true;
+}
+
+/**
+ * @brief Give up the KCF tracker. The caller takes its ownership.
+ *
+ * @param void void.
+ * 
+ * @return The KCF tracker, or `nullptr` if there's none.
+ * 
+ */
+KCFTracker* Tracking::detachKCF(void){
+
+    KCFTracker* p_kcf = _p_kcf;
+    _p_kcf = nullptr;
+
+    return p_kcf;
+}
+
+/**
+ * @brief Set the ID of the tracked object.
+ *
+ * @param id        ID of the tracked object.
+ * 
+ * @return Boolean value. Return `true` if the setting goes on properly. 
+ * 
+ */
+bool Tracking::setId(int id){
+
+    _id = id;
+
+    return true;
+}
+
+/**
+ * @brief Get the ID of the tracked object.
+ *
+ * Encapsulation protects class data by using functions for access, 
+ * preventing accidental changes.
+ * 
+ * @param void void.
+ * 
+ * @return The ID of the tracked object.
+ * 
+ */
+int Tracking::getId(void) const{
+    return _id;
+}
+
+/**
+ * @brief Get the velocity of the tracked object.
+ *
+ * Encapsulation protects class data by using functions for access, 
+ * preventing accidental changes.
+ * 
+ * @param void void.
+ * 
+ * @return Velocity of the box center, in pixels per frame.
+ * 
+ */
+cv::Point2f Tracking::getVelocity(void) const{
+    return _velocity;
+}
+
+/**
+ * @brief Get the result of the tracker in the latest frame.
+ *
+ * @param void void.
+ * 
+ * @return Identity, bounding box and confidence of the tracker.
+ * 
+ */
+tcrResult Tracking::getResult(void) const{
+
+    return {_id, _roi, state, _current_apce_value, _mean_apce_value, _peak_value, _mean_peak_value, 
+            _apce_accepted};
+}
+
+/**
+ * @brief Take the ownership of a KCF tracker. The current one, if any, is deleted.
+ *
+ * @param p_kcf     The KCF tracker.
+ * 
+ * @return Boolean value. Return `true` if the attaching goes on properly. 
+ * 
+ */
+bool Tracking::attachKCF(KCFTracker* p_kcf){
+
+    if(_p_kcf != nullptr) delete _p_kcf;
+    _p_kcf = p_kcf;
+
+    return true;
+}
+
+/**
+ * @brief Whether the tracker owns a KCF tracker.
+ *
+ * @param void void.
+ * 
+ * @return Boolean value. Return `true` if it owns one.
+ * 
+ */
+bool Tracking::hasKCF(void) const{
+    return _p_kcf != nullptr;
+}
@@ -7,6 +7,9 @@
 #include "funcs.hpp"
 #include "detect.hpp"
 #include "kcftracker.hpp"
+#include "reid.hpp"
+
+#include <functional>
 
 /* Tracker States. */
 
@@ -34,12 +37,100 @@
 /* Reduce a sub-state. A sub-state will reach a final state by reducing. */
 #define REDUCE_SUB_STATE(state) (-- state)
 
-/* Meaning-less index. */
-#define INVALID_INDEX (-1)
-
-/* Maximum trackers running at the same time. */
+/* Maximum trackers running at the same time. Trackers are allocated on demand, 
+   so it can be raised to hundreds without per-frame cost. */
 #define MAX_TCR (20)
 
+/* Trackers allocated at once when the tracker pool grows. */
+#define TCR_POOL_CHUNK (8)
+
+/* Idle KCF trackers kept for reuse. */
+#define KCF_POOL_SIZE (8)
+
+/* Time budget for updating all trackers in one frame, in milliseconds of CPU time summed over 
+   the updates. Updates run in parallel take about this divided by the number of threads. */
+#define TCR_BUDGET_MS (60.0f)
+
+/* Every running tracker gets updated at least once within TCR_MAX_DEFER frames. */
+#define TCR_MAX_DEFER (3)
+
+/* A matched tracker whose cost is TCR_MAX_COST or more is restarted on the detection. */
+#define TCR_MAX_COST (0.5f)
+
+/* Kernel of the KCF trackers. A linear kernel is faster but slightly less accurate than the Gaussian one. */
+#define KCF_LINEAR_KERNEL (false)
+
+/* Storage of KCF templates and models: QMAT_FLOAT32, QMAT_FLOAT16 or QMAT_INT8 (per-channel scale).
+   The rounding error is carried into the next training as int8, so the stored model takes 
+   3 (fp16) or 2 (int8) bytes per value instead of 4, and keeps adapting at small learning rates. */
+#define KCF_MODEL_PRECISION (QMAT_FLOAT32)
+
+/* Change-gated KCF training. While the detected features correlate with the template above
+   KCF_TRAIN_SIMILARITY, training is deferred, at most KCF_TRAIN_MAX_SKIP frames in a row.
+   The deferred weight is added to the next training. 1 trains every accepted frame, which is
+   the default until a threshold has been validated against ground truth with `sweep`. */
+#define KCF_TRAIN_SIMILARITY (1.0f)
+#define KCF_TRAIN_MAX_SKIP (4)
+
+/* Runs `body(0)` to `body(n - 1)`, possibly in parallel, and returns when all are done. */
+typedef std::function<void(int n, const std::function<void(int)>& body)> parallelForFn;
+
+/* Update modes picked by the scheduler. */
+#define TCR_UPD_DEFER (0x00)
+#define TCR_UPD_TRANS (0x01)
+#define TCR_UPD_FULL (0x02)
+
+
+
+/**
+ * @struct trackConfig
+ * @brief Runtime settings of the Tracking. Defaults are the macros above.
+ * 
+ */
+struct trackConfig{
+
+    trackConfig(int max_tcr = MAX_TCR, float budget_ms = TCR_BUDGET_MS, int max_defer = TCR_MAX_DEFER)
+        : max_tcr(max_tcr), budget_ms(budget_ms), max_defer(max_defer) {}
+
+    int max_tcr;
+    float budget_ms;
+    int max_defer;
+    float max_cost = TCR_MAX_COST;
+
+    /* KCF trackers. Zero keeps the value `KCFTracker` picks for its features. */
+    int kcf_template_size = 0;
+    int kcf_cell_size = 0;
+    float kcf_padding = 0.0f;
+    float kcf_interp_factor = 0.0f;
+
+    float kcf_train_similarity = KCF_TRAIN_SIMILARITY;
+    int kcf_train_max_skip = KCF_TRAIN_MAX_SKIP;
+    int kcf_model_precision = KCF_MODEL_PRECISION;
+
+    bool configureKCF(KCFTracker* p_kcf) const;
+
+    void validate(void) const;
+};
+
+
+/**
+ * @struct tcrResult
+ * @brief Result of a running tracker in the latest frame, with all that's needed to draw it.
+ * 
+ */
+struct tcrResult{
+
+    int id;
+    Rect roi;
+    char state;
+
+    /* APCE and peak of the latest response map, and their running means. */
+    float apce;
+    float mean_apce;
+    float peak;
+    float mean_peak;
+    bool accepted;
+};
 
 
 /**
@@ -62,18 +153,32 @@ public:
         }
     }
 
-    bool update(Mat& frame);
+    bool update(const Mat& frame, bool full = true);
+    bool defer(void);
 
     /* `start` is included in `restart`. */
-    bool restart(Mat first_f, Rect roi, char _state = TCR_RUNN, 
+    bool restart(Mat first_f, Rect roi, const trackConfig& cfg, char _state = TCR_RUNN, 
         bool hog = true, bool fixed_window = true, bool multiscale = true, 
-        bool lab = true);
+        bool lab = true, bool linear = KCF_LINEAR_KERNEL);
+
+    bool revive(int id, KCFTracker* p_kcf, Rect roi);
+    bool attachKCF(KCFTracker* p_kcf);
+    KCFTracker* detachKCF(void);
+    bool hasKCF(void) const;
+    bool setId(int id);
     
+    int getId(void) const;
     Rect getROI(void) const;
     float getScore(void) const;
     float getApce(void) const;
     float getPeak(void) const;
+    float getPSR(void) const;
+    const KCFKernels::responseStats& getResponse(void) const;
     Mat getAppearance(void) const;
+    float getUpdateCost(bool full) const;
+    int getDeferred(void) const;
+    cv::Point2f getVelocity(void) const;
+    tcrResult getResult(void) const;
 
     /* 8 bit. */
     char state;
@@ -101,6 +206,80 @@ protected:
 
     bool _apce_accepted = true;
 
+    /* Statistics of the latest response map: PSR, second peak, etc. */
+    KCFKernels::responseStats _response = KCFKernels::responseStats();
+
+    /* Frames skipped by the scheduler since the last update. */
+    int _deferred = 0;
+
+    /* Velocity of the box center, in pixels per frame. */
+    cv::Point2f _velocity = cv::Point2f(0.0f, 0.0f);
+    float _alpha_velocity = 0.3f;
+
+    /* Frame when the tracker was lost. */
+    uint_fast32_t _lost_clock = 0;
+
+    /* Intrusive links of the tracker list `objTrack` keeps it in. */
+    int _prev_index = INVALID_INDEX;
+    int _next_index = INVALID_INDEX;
+
+    friend class objTrack;
+
+};
+
+
+/**
+ * @struct tcrList
+ * @brief An intrusive doubly linked list of trackers, linked by tracker index.
+ * 
+ */
+struct tcrList{
+
+    int head = INVALID_INDEX;
+    int tail = INVALID_INDEX;
+    int size = 0;
+};
+
+
+/**
+ * @class tcrSoA
+ * @brief Structure-of-arrays mirror of the running and lost trackers.
+ * 
+ * Tracker states are packed in contiguous arrays, so association can be done by tight loops 
+ * over them instead of calls on scattered `Tracking` objects. Position `i` of every array 
+ * describes the same tracker, `tcr_index[i]`.
+ * 
+ */
+class tcrSoA{
+
+public:
+
+    bool add(int index);
+    bool remove(int index);
+    bool sync(int index, const Tracking& tcr);
+    bool reserve(int capacity);
+
+    int size(void) const;
+    int posOf(int index) const;
+
+    vector<int> tcr_index;
+
+    /* Bounding boxes. */
+    vector<float> x;
+    vector<float> y;
+    vector<float> w;
+    vector<float> h;
+
+    vector<char> state;
+    vector<float> score;
+    vector<float> apce;
+    vector<float> peak;
+    vector<float> psr;
+
+protected:
+
+    /* Position of every tracker in the arrays, `INVALID_INDEX` if it's not mirrored. */
+    vector<int> _pos;
 };
 
 
@@ -115,38 +294,112 @@ public:
 
     objTrack():max_tcr(0){}
 
-    objTrack(int max_tcr = MAX_TCR):
-                    max_tcr(max_tcr){
+    objTrack(int max_tcr = MAX_TCR, float budget_ms = TCR_BUDGET_MS, int max_defer = TCR_MAX_DEFER):
+                    objTrack(trackConfig(max_tcr, budget_ms, max_defer)) {}
 
-        _p_tcrs = new Tracking[max_tcr];
+    explicit objTrack(const trackConfig& cfg):
+                    max_tcr(cfg.max_tcr), _cfg(cfg), _budget_ms(cfg.budget_ms), _max_defer(cfg.max_defer){
 
-        for(int i = 0; i < max_tcr; ++ i){
-            _p_tcrs[i] = std::move(Tracking(i));
-        }
+        _cfg.validate();
 
+        /* Trackers are allocated on demand, start with one chunk. */
+        grow();
     }
     ~objTrack(){
-        if(_p_tcrs != nullptr){
-            delete[] _p_tcrs;
+        for(Tracking* p_chunk: _p_chunks){
+            delete[] p_chunk;
+        }
+        for(KCFTracker* p_kcf: _p_kcf_pool){
+            delete p_kcf;
+        }
+        if(_p_feature_kcf != nullptr){
+            delete _p_feature_kcf;
         }
     }
 
-    bool tick(Mat& frame, vector<fdObject> fd_objs = {});
+    bool tick(const Mat& frame, vector<fdObject> fd_objs = {});
 
     bool getCostMatrix(const Mat& frame, const vector<fdObject>& fd_objs, Mat& cost);
-    bool hungarianMatch(const vector<fdObject>& fd_objs, const Mat& cost, vector<int>& matched_tcr_index);
+    bool hungarianMatch(const vector<fdObject>& fd_objs, const Mat& cost, vector<int>& matched_tcr_row);
     
-    int getFreeTcrIndex(void);
+    int getFreeTcrIndex(const vector<int>& keep = {});
+
+    bool scheduleUpdates(vector<int>& tcr_index, vector<char>& modes);
+
+    int capacity(void) const;
+
+    bool archiveTcr(int index);
+    KCFTracker* acquireKCF(void);
+    bool recycleKCF(KCFTracker* p_kcf);
+    bool configureKCF(KCFTracker* p_kcf) const;
 
     vector<Rect> getROIs(void) const;
+    bool getResults(vector<tcrResult>& results) const;
+    int getWeakCount(void) const;
 
     Mat getFeature(const Rect roi, const Mat& frame);
 
+    bool setParallelFor(parallelForFn parallel_for);
+
     const int max_tcr;
 
 protected:
 
-    Tracking* _p_tcrs = nullptr;
+    bool timedUpdates(const vector<int>& tcr_index, const vector<char>& modes, const Mat& frame);
+
+    bool grow(void);
+
+    Tracking& tcrAt(int index);
+    const Tracking& tcrAt(int index) const;
+
+    tcrList& listOf(char state);
+    vector<int> listIndex(const tcrList& list) const;
+    bool setTcrState(int index, char state);
+    bool linkTcr(tcrList& list, int index);
+    bool unlinkTcr(tcrList& list, int index);
+
+    /* Trackers live in chunks, so their addresses stay valid when the pool grows. */
+    vector<Tracking*> _p_chunks;
+    int _capacity = 0;
+
+    /* READY, RUNN and LOST trackers, each kept in its own list. */
+    tcrList _free_tcrs;
+    tcrList _runn_tcrs;
+    tcrList _lost_tcrs;
+
+    /* Running and lost trackers, mirrored after every change. Rows of the cost matrix follow it. */
+    tcrSoA _soa;
+
+    /* Appearance descriptors of the latest detected objects, computed by `getCostMatrix`. */
+    vector<Mat> _fd_features;
+
+    /* Lost tracks whose trackers were taken over, kept for re-identification. */
+    reidGallery _gallery;
+
+    /* Frames processed. */
+    uint_fast32_t _clock = 0;
+
+    /* ID for the next new track. */
+    int _next_id = 0;
+
+    /* Idle KCF trackers, re-initialized instead of allocating new ones. */
+    vector<KCFTracker*> _p_kcf_pool;
+
+    /* Extracts appearance features of detected objects, created on first use. */
+    KCFTracker* _p_feature_kcf = nullptr;
+
+    /* Runs the tracker updates of a frame. Empty for one after another. */
+    parallelForFn _parallel_for;
+
+    const trackConfig _cfg = trackConfig();
+
+    /* Update scheduling. */
+    float _budget_ms = TCR_BUDGET_MS;
+    int _max_defer = TCR_MAX_DEFER;
+
+    /* Measured CPU time of an update per cost unit. Zero until the first measurement. */
+    float _ms_per_cost = 0.0f;
+    float _alpha_cost = 0.1f;
 
 
 };
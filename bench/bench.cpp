@@ -0,0 +1,390 @@
+/**
+ * @file bench.cpp
+ * @brief Microbenchmarks of the core kernels of Detection and Tracking, on frames of the test set.
+ * @author wantSomeChips
+ * @date 2025
+ * 
+ * Usage: `bench [<input> [<gt.txt>]] [key=value ...]`
+ * 
+ * Defaults are the test set `PETS09-S2L1` and its ground truth. The first `BENCH_FRAMES` frames 
+ * are loaded, the background model and the trackers are brought up on them, and the kernels 
+ * run on the last one. KCF kernels use a target of median size among the objects in that frame. 
+ * Results go to the standard output as JSON, so runs can be compared with any JSON tool.
+ * 
+ */
+
+#include "bench.hpp"
+#include "funcs.hpp"
+#include "detect.hpp"
+#include "track.hpp"
+#include "config.hpp"
+#include "source.hpp"
+#include "motmetrics.hpp"
+
+#include "kcftracker.hpp"
+#include "ffttools.hpp"
+#include "fhog.hpp"
+#include "recttools.hpp"
+
+#include <sstream>
+
+/* Frames loaded. Enough for the background model to be initialized. */
+#define BENCH_FRAMES (40)
+
+/* Set by the build, see the top-level CMakeLists.txt. */
+#ifndef MOT_FFT_BACKEND
+#define MOT_FFT_BACKEND "OPENCV"
+#endif
+
+
+/**
+ * @class benchKCF
+ * @brief KCF tracker with its internal kernels open to the benchmarks.
+ *
+ */
+class benchKCF: public KCFTracker{
+
+public:
+
+    benchKCF(): KCFTracker(true, true, true, true, KCF_LINEAR_KERNEL) {}
+
+    using KCFTracker::detect;
+    using KCFTracker::train;
+    using KCFTracker::gaussianCorrelation;
+
+    cv::Size templateSize(void) const{
+        return _tmpl_sz;
+    }
+};
+
+
+/**
+ * @class benchDetect
+ * @brief Detection with the state of its background model visible.
+ *
+ */
+class benchDetect: public objDetect{
+
+public:
+
+    using objDetect::objDetect;
+
+    bool backgroundReady(void) const{
+        return _backgrnd_initialized;
+    }
+};
+
+
+static string shapeOf(int width, int height, int channels = 1){
+
+    std::ostringstream out;
+    out << width << "x" << height;
+    if(channels > 1){
+        out << "x" << channels;
+    }
+
+    return out.str();
+}
+
+static void writeString(std::ostream& out, const string& str){
+
+    out << '"';
+    for(char c: str){
+        if(c == '"' || c == '\\'){
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+/**
+ * @brief Write the results, and what they were measured on, as one JSON object.
+ *
+ * @param out       Stream to write to.
+ * @param context   Pairs of name and value describing the run.
+ *
+ */
+void benchSuite::writeJSON(std::ostream& out, const vector<std::pair<string, string>>& context) const{
+
+    out << "{\n";
+
+    for(const auto& item: context){
+
+        out << "  ";
+        writeString(out, item.first);
+        out << ": ";
+        writeString(out, item.second);
+        out << ",\n";
+    }
+
+    out << "  \"benchmarks\": [\n";
+
+    for(size_t i = 0; i < _results.size(); ++ i){
+
+        const benchResult& res = _results[i];
+
+        out << "    {\"name\": ";
+        writeString(out, res.name);
+        out << ", \"shape\": ";
+        writeString(out, res.shape);
+        out << ", \"runs\": " << res.runs << ", \"mean_us\": " << res.mean_us 
+            << ", \"median_us\": " << res.median_us << ", \"min_us\": " << res.min_us
+            << ", \"max_us\": " << res.max_us << "}" << (i + 1 < _results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}" << endl;
+}
+
+
+int main(int argc, char* argv[]){
+
+    string input = string("../") + NAME + "/" + imDir + "/%06d" + imExt;
+    string gt_path = string("../") + NAME + "/gt/gt.txt";
+
+    motConfig cfg;
+    vector<string> paths;
+
+    for(int i = 1; i < argc; ++ i){
+
+        string arg = argv[i];
+
+        if(arg.find('=') == string::npos){
+            paths.push_back(arg);
+        }
+        else if(false == cfg.set(arg)){
+            std::cerr << "ERROR: Unknown setting: " << arg << endl;
+            return ERR_ARG_NUM;
+        }
+    }
+
+    string error;
+    if(false == cfg.validate(error)){
+        std::cerr << "ERROR: Invalid settings: " << error << endl;
+        return ERR_ARG_NUM;
+    }
+
+    if(paths.size() > 2){
+        std::cerr << "Usage: bench [<input> [<gt.txt>]] [key=value ...]" << endl;
+        return ERR_ARG_NUM;
+    }
+    if(paths.size() > 0){
+        input = paths[0];
+    }
+    if(paths.size() > 1){
+        gt_path = paths[1];
+    }
+
+    /* Kernels are measured on one core. */
+    cv::setNumThreads(0);
+
+    /* Frames are copied, sources may reuse or map their buffers. */
+    vector<Mat> frames;
+    frameSource* source = frameSource::open(input);
+    Mat frame;
+
+    while(source != nullptr && (int)frames.size() < BENCH_FRAMES && source -> read(frame)){
+        frames.push_back(frame.clone());
+    }
+    delete source;
+
+    if((int)frames.size() < BENCH_FRAMES){
+
+        std::cerr << "ERRO: Failed to Read " << BENCH_FRAMES << " Frames: " << input << endl;
+        return 1;
+    }
+
+    const Mat& last = frames.back();
+    const int last_index = frames.size();
+    const string frame_shape = shapeOf(last.cols, last.rows);
+
+    benchSuite suite;
+
+
+    /* Detection. The background model is brought up on the frames before the last one. */
+    benchDetect detect(frames[0], cfg.detect);
+
+    for(int i = 1; i < last_index - 1; ++ i){
+        detect.tick(frames[i]);
+    }
+
+    if(false == detect.backgroundReady()){
+        std::cerr << "WARN: Background Model Not Initialized" << endl;
+    }
+
+    Mat gray, resp, resp_in;
+    cv::cvtColor(last, gray, cv::COLOR_BGR2GRAY);
+    detect.getBackgrndDiffResp(gray, resp);
+
+    vector<Rect> rects = detect.getRects(resp);
+
+    suite.run("objDetect::getBackgrndDiffResp", frame_shape, [&](){ 
+        detect.getBackgrndDiffResp(gray, resp); });
+
+    /* Contours may be traced in place, each call gets a fresh response. */
+    suite.run("objDetect::getRects", frame_shape, [&](){ resp.copyTo(resp_in); }, [&](){ 
+        rects = detect.getRects(resp_in); });
+
+    suite.run("objDetect::backgrndUpdate", frame_shape, [&](){ 
+        detect.backgrndUpdate(gray, rects); });
+
+
+    /* Objects of the last frame: ground truth, or the detected ones without it. */
+    vector<motBox> gt;
+    vector<fdObject> fd_objs;
+    vector<vector<fdObject>> gt_objs(last_index + 1);
+
+    if(func::loadMOT(gt_path, gt)){
+
+        for(const motBox& box: gt){
+
+            if(box.frame <= last_index){
+                gt_objs[box.frame].push_back(fdObject(Rect(box.x, box.y, box.w, box.h)));
+            }
+        }
+        fd_objs = gt_objs[last_index];
+    }
+    else{
+
+        std::cerr << "WARN: No Ground Truth, Using Detected Objects: " << gt_path << endl;
+        for(const Rect& rect: rects){
+            fd_objs.push_back(fdObject(rect));
+        }
+    }
+
+    if(fd_objs.empty()){
+
+        std::cerr << "ERRO: No Object in Frame " << last_index << endl;
+        return 1;
+    }
+
+
+    /* Tracking. Trackers follow the objects of the frames before the last one. */
+    objTrack track(cfg.track);
+
+    for(int i = 1; i < last_index - 1; ++ i){
+
+        if(gt_objs[i + 1].empty()){
+            track.tick(frames[i]);
+        }
+        else{
+            track.tick(frames[i], gt_objs[i + 1]);
+        }
+    }
+
+    Mat cost;
+    vector<int> matched_tcr_row;
+    track.getCostMatrix(last, fd_objs, cost);
+
+    const string cost_shape = shapeOf(cost.cols, cost.rows);
+
+    suite.run("objTrack::getCostMatrix", cost_shape, [&](){ 
+        track.getCostMatrix(last, fd_objs, cost); });
+
+    suite.run("objTrack::hungarianMatch", cost_shape, [&](){ 
+        track.hungarianMatch(fd_objs, cost, matched_tcr_row); });
+
+
+    /* KCF, on the object of median area. */
+    std::sort(fd_objs.begin(), fd_objs.end(), [](const fdObject& a, const fdObject& b){
+        return a.resultRect().area() < b.resultRect().area(); });
+    const Rect roi = fd_objs[fd_objs.size() / 2].resultRect();
+
+    benchKCF kcf;
+    track.configureKCF(&kcf);
+    kcf.init(roi, last);
+
+    /* Padded window around the target, resized to the template, as `getFeatures` does. */
+    const cv::Size tmpl_sz = kcf.templateSize();
+    Rect window(roi.x + roi.width / 2 - cvRound(roi.width * kcf.padding / 2), 
+                roi.y + roi.height / 2 - cvRound(roi.height * kcf.padding / 2),
+                cvRound(roi.width * kcf.padding), cvRound(roi.height * kcf.padding));
+
+    Mat patch = RectTools::subwindow(last, window, cv::BORDER_REPLICATE);
+    cv::resize(patch, patch, tmpl_sz);
+    IplImage patch_ipl = cvIplImage(patch);
+
+    const string patch_shape = shapeOf(patch.cols, patch.rows, patch.channels());
+    CvLSVMFeatureMapCaskade* map = nullptr;
+
+    auto freeMap = [&](){
+        if(map != nullptr){
+            freeFeatureMapObject(&map);
+        }
+    };
+
+    suite.run("getFeatureMaps", patch_shape, freeMap, [&](){ 
+        getFeatureMaps(&patch_ipl, kcf.cell_size, &map); });
+
+    suite.run("normalizeAndTruncate", patch_shape, [&](){ 
+        freeMap(); 
+        getFeatureMaps(&patch_ipl, kcf.cell_size, &map); 
+    }, [&](){ 
+        normalizeAndTruncate(map, 0.2f); });
+
+    suite.run("PCAFeatureMaps", patch_shape, [&](){ 
+        freeMap(); 
+        getFeatureMaps(&patch_ipl, kcf.cell_size, &map); 
+        normalizeAndTruncate(map, 0.2f); 
+    }, [&](){ 
+        PCAFeatureMaps(map); });
+
+    freeMap();
+
+    /* Features of the target, one row per channel, and the template they are compared with. */
+    Mat x = kcf.getFeatures(last, false);
+    Mat tmpl = kcf.getTmpl();
+    Mat k = kcf.gaussianCorrelation(x, tmpl);
+
+    const string feature_shape = shapeOf(k.cols, k.rows, x.rows);
+    const string map_shape = shapeOf(k.cols, k.rows);
+
+    suite.run("KCFTracker::gaussianCorrelation", feature_shape, [&](){ 
+        k = kcf.gaussianCorrelation(x, tmpl); });
+
+    Mat spec, spec_b, product, inverse;
+    FFTTools::fftd(k, spec);
+    FFTTools::fftd(k.t(), spec_b);
+    spec_b = spec_b.t();
+
+    suite.run("FFTTools::fftd", map_shape, [&](){ 
+        FFTTools::fftd(k, spec); });
+
+    suite.run("FFTTools::fftd/inverse", map_shape, [&](){ 
+        FFTTools::fftd(spec, inverse, true); });
+
+    suite.run("FFTTools::complexMultiplication", map_shape, [&](){ 
+        product = FFTTools::complexMultiplication(spec, spec_b); });
+
+    suite.run("FFTTools::complexMultiply", map_shape, [&](){ 
+        FFTTools::complexMultiply(spec, spec_b, product); });
+
+    /* Confidence statistics are reset for every call, so they all see the same state. */
+    float peak, mean_peak, mean_apce, apce;
+    bool accepted;
+
+    suite.run("KCFTracker::detect", feature_shape, [&](){ 
+        peak = mean_peak = mean_apce = apce = 0.0f; 
+    }, [&](){ 
+        kcf.detect(tmpl, x, peak, 0.5f, 0.5f, 0.1f, mean_peak, mean_apce, apce, accepted); });
+
+    suite.run("KCFTracker::train", feature_shape, [&](){ 
+        kcf.train(x, kcf.interp_factor); });
+
+
+    std::ostringstream target;
+    target << roi.x << "," << roi.y << "," << roi.width << "," << roi.height;
+
+    suite.writeJSON(cout, {
+        {"input", input},
+        {"frame", std::to_string(last_index)},
+        {"frame_size", frame_shape},
+        {"objects", std::to_string(fd_objs.size())},
+        {"target", target.str()},
+        {"settings", cfg.str()},
+        {"fft_backend", MOT_FFT_BACKEND},
+        {"cv_version", CV_VERSION}
+    });
+
+    return 0;
+}
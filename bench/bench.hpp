@@ -0,0 +1,106 @@
+#pragma once
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include "funcs.hpp"
+
+#include <chrono>
+#include <algorithm>
+#include <ostream>
+
+/* Each kernel runs at least this long in total, and at least `BENCH_MIN_RUNS` times. */
+#define BENCH_MIN_MS (200)
+#define BENCH_MIN_RUNS (20)
+#define BENCH_MAX_RUNS (100000)
+
+
+/**
+ * @struct benchResult
+ * @brief Timings of one kernel, per call.
+ *
+ */
+struct benchResult{
+
+    string name;
+
+    /* Size of the input, e.g. "768x576". */
+    string shape;
+
+    long runs = 0;
+    double mean_us = 0.0;
+    double median_us = 0.0;
+    double min_us = 0.0;
+    double max_us = 0.0;
+};
+
+
+/**
+ * @class benchSuite
+ * @brief Times kernels call by call, and writes the results as JSON.
+ *
+ * A kernel is a `body` and an optional `setup`, which prepares the input of every call 
+ * and is not timed. The first call is a warm-up and is not counted either.
+ *
+ */
+class benchSuite{
+
+public:
+
+    explicit benchSuite(double min_ms = BENCH_MIN_MS): _min_ms(min_ms) {}
+
+    template <class Setup, class Body>
+    const benchResult& run(const string& name, const string& shape, Setup setup, Body body){
+
+        typedef std::chrono::steady_clock clock;
+
+        setup();
+        body();
+
+        vector<double> us;
+        double total_ms = 0.0;
+
+        while((total_ms < _min_ms || (long)us.size() < BENCH_MIN_RUNS) && (long)us.size() < BENCH_MAX_RUNS){
+
+            setup();
+
+            clock::time_point start = clock::now();
+            body();
+            double elapsed_us = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+
+            us.push_back(elapsed_us);
+            total_ms += elapsed_us / 1000.0;
+        }
+
+        benchResult res;
+        res.name = name;
+        res.shape = shape;
+        res.runs = us.size();
+        res.mean_us = 1000.0 * total_ms / us.size();
+        res.min_us = *std::min_element(us.begin(), us.end());
+        res.max_us = *std::max_element(us.begin(), us.end());
+
+        std::nth_element(us.begin(), us.begin() + us.size() / 2, us.end());
+        res.median_us = us[us.size() / 2];
+
+        _results.push_back(res);
+
+        return _results.back();
+    }
+
+    template <class Body>
+    const benchResult& run(const string& name, const string& shape, Body body){
+
+        return run(name, shape, [](){}, body);
+    }
+
+    void writeJSON(std::ostream& out, const vector<std::pair<string, string>>& context) const;
+
+private:
+
+    double _min_ms;
+    vector<benchResult> _results;
+};
+
+
+#endif
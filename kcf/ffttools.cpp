@@ -1,75 +1,87 @@
-
-
-
 #include "ffttools.hpp"
 
+#ifdef KCF_FFT_KISS
+#include "kissfft.hpp"
+#endif
 
+#include <map>
+#include <memory>
+#include <tuple>
 
+#if defined(__AVX__) || defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 
-
-cv::Mat FFTTools::fftd(cv::Mat img, bool backwards)
-{
-/*
-#ifdef USE_FFTW
-
-    fftw_complex * fm = (fftw_complex*) fftw_malloc(sizeof (fftw_complex) * img.cols * img.rows);
-
-    fftw_plan p = fftw_plan_dft_2d(img.rows, img.cols, fm, fm, backwards ? 1 : -1, 0 * FFTW_ESTIMATE);
-
-
-    if (img.channels() == 1)
+namespace {
+    // Not a cached plan: cv::dft factorizes and computes its twiddles again on every call, and
+    // nothing here can be precomputed for it. Only the KISS backend caches real plans. This
+    // wrapper just keeps the flags and the zero imaginary plane merged with real input.
+    class opencvPlan : public FFTTools::fftPlan
     {
-        for (int i = 0; i < img.rows; i++)
-            for (int j = 0; j < img.cols; j++)
-            {
-                fm[i * img.cols + j][0] = img.at<float>(i, j);
-                fm[i * img.cols + j][1] = 0;
-            }
-    }
-    else
-    {
-        assert(img.channels() == 2);
-        for (int i = 0; i < img.rows; i++)
-            for (int j = 0; j < img.cols; j++)
-            {
-                fm[i * img.cols + j][0] = img.at<cv::Vec2d > (i, j)[0];
-                fm[i * img.cols + j][1] = img.at<cv::Vec2d > (i, j)[1];
-            }
-    }
-    fftw_execute(p);
-    cv::Mat res(img.rows, img.cols, CV_64FC2);
-
+    public:
+        opencvPlan(int rows, int cols, bool backwards)
+            : _rows(rows), _cols(cols), _flags(backwards ? (cv::DFT_INVERSE | cv::DFT_SCALE) : 0),
+              _zeros(cv::Mat::zeros(rows, cols, CV_32F)) {}
 
-    for (int i = 0; i < img.rows; i++)
-        for (int j = 0; j < img.cols; j++)
+        void execute(cv::Mat src, cv::Mat& dst)
         {
-            res.at<cv::Vec2d > (i, j)[0] = fm[i * img.cols + j][0];
-            res.at<cv::Vec2d > (i, j)[1] = fm[i * img.cols + j][1];
+            assert(src.rows == _rows && src.cols == _cols);
 
-            //  _iout(fm[i * img.cols + j][0]);
+            if (src.channels() == 1) {
+                cv::Mat planes[] = {src, _zeros};
+                dst.create(_rows, _cols, CV_32FC2);
+                cv::merge(planes, 2, dst);
+            }
+            else if (dst.data != src.data) {
+                src.copyTo(dst);
+            }
+            cv::dft(dst, dst, _flags);
         }
 
-    if (backwards)res *= 1.d / (float) (res.cols * res.rows);
+    private:
+        int _rows;
+        int _cols;
+        int _flags;
+        cv::Mat _zeros;
+    };
+}
 
-    fftw_free(p);
-    fftw_free(fm);
-    return res;
 
+FFTTools::fftPlan& FFTTools::plan(int rows, int cols, bool backwards)
+{
+    static thread_local std::map<std::tuple<int, int, bool>, std::unique_ptr<fftPlan> > plans;
+
+    std::unique_ptr<fftPlan>& p = plans[std::make_tuple(rows, cols, backwards)];
+    if (!p) {
+#ifdef KCF_FFT_KISS
+        p.reset(new kissPlan(rows, cols, backwards));
 #else
-*/
-    if (img.channels() == 1)
-    {
-        cv::Mat planes[] = {cv::Mat_<float> (img), cv::Mat_<float>::zeros(img.size())};
-        //cv::Mat planes[] = {cv::Mat_<double> (img), cv::Mat_<double>::zeros(img.size())};
-        cv::merge(planes, 2, img);
+        p.reset(new opencvPlan(rows, cols, backwards));
+#endif
     }
-    cv::dft(img, img, backwards ? (cv::DFT_INVERSE | cv::DFT_SCALE) : 0 );
+    return *p;
+}
 
-    return img;
+cv::Mat FFTTools::fftd(cv::Mat img, bool backwards)
+{
+    // Complex input is transformed in place
+    cv::Mat res;
+    if (img.channels() == 2)
+        res = img;
 
-/*#endif*/
+    fftd(img, res, backwards);
+    return res;
+}
+
+void FFTTools::fftd(cv::Mat img, cv::Mat& dst, bool backwards)
+{
+    if (img.depth() != CV_32F)
+        img.convertTo(img, CV_32F);
 
+    plan(img.rows, img.cols, backwards).execute(img, dst);
 }
 
 cv::Mat FFTTools::real(cv::Mat img)
@@ -97,39 +109,159 @@ cv::Mat FFTTools::magnitude(cv::Mat img)
     return res;
 }
 
-cv::Mat FFTTools::complexMultiplication(cv::Mat a, cv::Mat b)
-{
-    std::vector<cv::Mat> pa;
-    std::vector<cv::Mat> pb;
-    cv::split(a, pa);
-    cv::split(b, pb);
+namespace {
+    enum complexOp { CPX_MUL, CPX_MUL_ADD, CPX_DIV };
 
-    std::vector<cv::Mat> pres;
-    pres.push_back(pa[0].mul(pb[0]) - pa[1].mul(pb[1]));
-    pres.push_back(pa[0].mul(pb[1]) + pa[1].mul(pb[0]));
+    // One pass over n interleaved complex values: 4 (AVX), 2 (SSE) or 4 deinterleaved (NEON on AArch64)
+    // at a time, the rest one by one. With sign = -1 (conjugate b) products use a * conj(b).
+    template <int OP>
+    void complexRow(const float* a, const float* b, float* dst, int n, bool conj_b)
+    {
+        const float sign = conj_b ? -1.f : 1.f;
+        int i = 0;
 
-    cv::Mat res;
-    cv::merge(pres, res);
+#if defined(__AVX__)
+        {
+            // Products are a * re(b) + swap(a) * im(b) * (-s, s) per complex value
+            const __m256 v_sign = conj_b ? _mm256_setr_ps(1, -1, 1, -1, 1, -1, 1, -1)
+                                         : _mm256_setr_ps(-1, 1, -1, 1, -1, 1, -1, 1);
+            for (; i + 4 <= n; i += 4) {
+                __m256 va = _mm256_loadu_ps(a + 2 * i), vb = _mm256_loadu_ps(b + 2 * i);
+                __m256 b_re = _mm256_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+                __m256 b_im = _mm256_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+                __m256 a_sw = _mm256_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));
+
+                if (OP == CPX_DIV) {
+                    __m256 num = _mm256_add_ps(_mm256_mul_ps(va, b_re), _mm256_mul_ps(a_sw, b_im));
+                    __m256 den = _mm256_add_ps(_mm256_mul_ps(b_re, b_re), _mm256_mul_ps(b_im, b_im));
+                    _mm256_storeu_ps(dst + 2 * i, _mm256_div_ps(num, den));
+                }
+                else {
+                    __m256 prod = _mm256_add_ps(_mm256_mul_ps(va, b_re),
+                                                _mm256_mul_ps(_mm256_mul_ps(a_sw, b_im), v_sign));
+                    if (OP == CPX_MUL_ADD)
+                        prod = _mm256_add_ps(prod, _mm256_loadu_ps(dst + 2 * i));
+                    _mm256_storeu_ps(dst + 2 * i, prod);
+                }
+            }
+        }
+#endif
 
-    return res;
+#if defined(__SSE__) || defined(_M_X64)
+        {
+            const __m128 v_sign = conj_b ? _mm_setr_ps(1, -1, 1, -1) : _mm_setr_ps(-1, 1, -1, 1);
+            for (; i + 2 <= n; i += 2) {
+                __m128 va = _mm_loadu_ps(a + 2 * i), vb = _mm_loadu_ps(b + 2 * i);
+                __m128 b_re = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+                __m128 b_im = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+                __m128 a_sw = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));
+
+                if (OP == CPX_DIV) {
+                    __m128 num = _mm_add_ps(_mm_mul_ps(va, b_re), _mm_mul_ps(a_sw, b_im));
+                    __m128 den = _mm_add_ps(_mm_mul_ps(b_re, b_re), _mm_mul_ps(b_im, b_im));
+                    _mm_storeu_ps(dst + 2 * i, _mm_div_ps(num, den));
+                }
+                else {
+                    __m128 prod = _mm_add_ps(_mm_mul_ps(va, b_re), _mm_mul_ps(_mm_mul_ps(a_sw, b_im), v_sign));
+                    if (OP == CPX_MUL_ADD)
+                        prod = _mm_add_ps(prod, _mm_loadu_ps(dst + 2 * i));
+                    _mm_storeu_ps(dst + 2 * i, prod);
+                }
+            }
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        {
+            const float32x4_t v_sign = vdupq_n_f32(sign);
+            for (; i + 4 <= n; i += 4) {
+                float32x4x2_t va = vld2q_f32(a + 2 * i), vb = vld2q_f32(b + 2 * i);
+                float32x4_t b_im = vmulq_f32(vb.val[1], v_sign);
+                float32x4x2_t res;
+
+                if (OP == CPX_DIV) {
+                    float32x4_t den = vaddq_f32(vmulq_f32(vb.val[0], vb.val[0]), vmulq_f32(vb.val[1], vb.val[1]));
+                    res.val[0] = vdivq_f32(vaddq_f32(vmulq_f32(va.val[0], vb.val[0]), vmulq_f32(va.val[1], vb.val[1])), den);
+                    res.val[1] = vdivq_f32(vaddq_f32(vmulq_f32(va.val[1], vb.val[0]), vmulq_f32(va.val[0], vb.val[1])), den);
+                }
+                else {
+                    res.val[0] = vsubq_f32(vmulq_f32(va.val[0], vb.val[0]), vmulq_f32(va.val[1], b_im));
+                    res.val[1] = vaddq_f32(vmulq_f32(va.val[1], vb.val[0]), vmulq_f32(va.val[0], b_im));
+                    if (OP == CPX_MUL_ADD) {
+                        float32x4x2_t acc = vld2q_f32(dst + 2 * i);
+                        res.val[0] = vaddq_f32(res.val[0], acc.val[0]);
+                        res.val[1] = vaddq_f32(res.val[1], acc.val[1]);
+                    }
+                }
+                vst2q_f32(dst + 2 * i, res);
+            }
+        }
+#endif
+
+        for (; i < n; i++) {
+            float ar = a[2 * i], ai = a[2 * i + 1];
+            float br = b[2 * i], bi = b[2 * i + 1];
+
+            if (OP == CPX_DIV) {
+                float den = br * br + bi * bi;
+                dst[2 * i] = (ar * br + ai * bi) / den;
+                dst[2 * i + 1] = (ai * br + ar * bi) / den;
+            }
+            else {
+                bi *= sign;
+                float re = ar * br - ai * bi;
+                float im = ai * br + ar * bi;
+                if (OP == CPX_MUL_ADD) {
+                    re += dst[2 * i];
+                    im += dst[2 * i + 1];
+                }
+                dst[2 * i] = re;
+                dst[2 * i + 1] = im;
+            }
+        }
+    }
+
+    template <int OP>
+    void complexApply(const cv::Mat& a, const cv::Mat& b, cv::Mat& dst, bool conj_b)
+    {
+        assert(a.type() == CV_32FC2 && b.type() == CV_32FC2 && a.size() == b.size());
+        assert(a.isContinuous() && b.isContinuous());
+
+        if (OP == CPX_MUL_ADD)
+            assert(dst.type() == CV_32FC2 && dst.size() == a.size());
+        else
+            dst.create(a.size(), CV_32FC2);
+        assert(dst.isContinuous());
+
+        complexRow<OP>((const float*) a.data, (const float*) b.data, (float*) dst.data, (int) a.total(), conj_b);
+    }
 }
 
-cv::Mat FFTTools::complexDivision(cv::Mat a, cv::Mat b)
+void FFTTools::complexMultiply(const cv::Mat& a, const cv::Mat& b, cv::Mat& dst, bool conj_b)
 {
-    std::vector<cv::Mat> pa;
-    std::vector<cv::Mat> pb;
-    cv::split(a, pa);
-    cv::split(b, pb);
+    complexApply<CPX_MUL>(a, b, dst, conj_b);
+}
 
-    cv::Mat divisor = 1. / (pb[0].mul(pb[0]) + pb[1].mul(pb[1]));
+void FFTTools::complexMultiplyAdd(const cv::Mat& a, const cv::Mat& b, cv::Mat& acc, bool conj_b)
+{
+    complexApply<CPX_MUL_ADD>(a, b, acc, conj_b);
+}
 
-    std::vector<cv::Mat> pres;
+// The imaginary part keeps the sign convention of the original KCF implementation
+void FFTTools::complexDivide(const cv::Mat& a, const cv::Mat& b, cv::Mat& dst)
+{
+    complexApply<CPX_DIV>(a, b, dst, false);
+}
 
-    pres.push_back((pa[0].mul(pb[0]) + pa[1].mul(pb[1])).mul(divisor));
-    pres.push_back((pa[1].mul(pb[0]) + pa[0].mul(pb[1])).mul(divisor));
+cv::Mat FFTTools::complexMultiplication(cv::Mat a, cv::Mat b)
+{
+    cv::Mat res;
+    complexMultiply(a, b, res);
+    return res;
+}
 
+cv::Mat FFTTools::complexDivision(cv::Mat a, cv::Mat b)
+{
     cv::Mat res;
-    cv::merge(pres, res);
+    complexDivide(a, b, res);
     return res;
 }
 
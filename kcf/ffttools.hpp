@@ -41,24 +41,48 @@ the use of this software, even if advised of the possibility of such damage.
 #define _OPENCV_FFTTOOLS_HPP_
 #endif
 
-//NOTE: FFTW support is still shaky, disabled for now.
-/*#ifdef USE_FFTW
-#include <fftw3.h>
-#endif*/
-
+// Backend chosen at build time: cv::dft by default, or the in-tree mixed-radix FFT with KCF_FFT_KISS.
 #include <opencv2/opencv.hpp>
 
 #include <vector>
 
 namespace FFTTools
 {
+// 2-D complex transform of one size and direction. The KISS backend precomputes its twiddles,
+// factorization and scratch when the plan is created. The cv::dft backend has no plan to keep
+// and redoes that work on every call.
+class fftPlan
+{
+public:
+    virtual ~fftPlan() {}
+    // src is CV_32FC1 or CV_32FC2 of the plan size. dst becomes CV_32FC2, its buffer is reused
+    // when it already has the right shape, and it may be src itself.
+    // Backward transforms are scaled by 1 / (rows * cols).
+    virtual void execute(cv::Mat src, cv::Mat& dst) = 0;
+};
+
+// Plan for (rows, cols, backwards), created on first use and cached per thread. Caching only
+// saves work with KCF_FFT_KISS.
+fftPlan& plan(int rows, int cols, bool backwards);
+
 // Previous declarations, to avoid warnings
 cv::Mat fftd(cv::Mat img, bool backwards = false);
+// Transform into a caller-owned buffer
+void fftd(cv::Mat img, cv::Mat& dst, bool backwards = false);
 cv::Mat real(cv::Mat img);
 cv::Mat imag(cv::Mat img);
 cv::Mat magnitude(cv::Mat img);
 cv::Mat complexMultiplication(cv::Mat a, cv::Mat b);
 cv::Mat complexDivision(cv::Mat a, cv::Mat b);
+
+// Kernels on interleaved CV_32FC2 spectra, vectorized when SIMD is available. Operands are continuous
+// and of one size. dst may be a or b, and is only allocated when it doesn't have that size already.
+// dst = a * b, or a * conj(b)
+void complexMultiply(const cv::Mat& a, const cv::Mat& b, cv::Mat& dst, bool conj_b = false);
+// acc += a * b, or a * conj(b)
+void complexMultiplyAdd(const cv::Mat& a, const cv::Mat& b, cv::Mat& acc, bool conj_b = false);
+// dst = a / b
+void complexDivide(const cv::Mat& a, const cv::Mat& b, cv::Mat& dst);
 void rearrange(cv::Mat &img);
 void normalizedLogTransform(cv::Mat &img);
 
@@ -0,0 +1,193 @@
+#include "kcfkernels.hpp"
+
+#include <utility>
+#include <vector>
+#include <cfloat>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace KCFKernels
+{
+// Geometries compiled in: the long side is KCF_LONG_SIDE cells, either vertical or horizontal,
+// and the short side any even number of cells up to it, for HOG and HOG + Lab features.
+namespace {
+    struct entry {
+        kernelGeometry g;
+        const kernelOps* ops;
+    };
+
+    template <int CH, int... S>
+    void addGeometries(entry* table, int& n, std::integer_sequence<int, S...>)
+    {
+        ((table[n++] = entry{{KCF_LONG_SIDE, 2 * (S + 1), CH}, &opsFor<fixedDims<KCF_LONG_SIDE, 2 * (S + 1), CH> >()}), ...);
+        ((table[n++] = entry{{2 * (S + 1), KCF_LONG_SIDE, CH}, &opsFor<fixedDims<2 * (S + 1), KCF_LONG_SIDE, CH> >()}), ...);
+    }
+
+    const int short_sides = KCF_LONG_SIDE / 2;
+    const int table_size = 2 * 2 * short_sides;
+
+    struct dispatchTable {
+        entry table[table_size];
+        int n = 0;
+
+        dispatchTable()
+        {
+            addGeometries<KCF_HOG_CHANNELS>(table, n, std::make_integer_sequence<int, short_sides>());
+            addGeometries<KCF_HOG_CHANNELS + KCF_LAB_CHANNELS>(table, n, std::make_integer_sequence<int, short_sides>());
+        }
+    };
+}
+
+const kernelOps& select(const kernelGeometry& g)
+{
+    static const dispatchTable dispatch;
+
+    for (int i = 0; i < dispatch.n; i++) {
+        const kernelGeometry& e = dispatch.table[i].g;
+        if (e.rows == g.rows && e.cols == g.cols && e.ch == g.ch)
+            return *dispatch.table[i].ops;
+    }
+    return opsFor<dynamicDims>();
+}
+
+namespace {
+    // Maximum, minimum, sum and sum of squares of one row, 4 values at a time when SIMD is available
+    void rowStats(const float* r, int n, float& mx, float& mn, float& sum, float& sq)
+    {
+        int i = 0;
+        mx = -FLT_MAX;
+        mn = FLT_MAX;
+        sum = 0;
+        sq = 0;
+
+#if defined(__SSE__) || defined(_M_X64)
+        if (n >= 4) {
+            __m128 v_mx = _mm_loadu_ps(r), v_mn = v_mx;
+            __m128 v_sum = _mm_setzero_ps(), v_sq = _mm_setzero_ps();
+            for (; i + 4 <= n; i += 4) {
+                __m128 v = _mm_loadu_ps(r + i);
+                v_mx = _mm_max_ps(v_mx, v);
+                v_mn = _mm_min_ps(v_mn, v);
+                v_sum = _mm_add_ps(v_sum, v);
+                v_sq = _mm_add_ps(v_sq, _mm_mul_ps(v, v));
+            }
+            float l_mx[4], l_mn[4], l_sum[4], l_sq[4];
+            _mm_storeu_ps(l_mx, v_mx);
+            _mm_storeu_ps(l_mn, v_mn);
+            _mm_storeu_ps(l_sum, v_sum);
+            _mm_storeu_ps(l_sq, v_sq);
+            for (int l = 0; l < 4; l++) {
+                mx = std::max(mx, l_mx[l]);
+                mn = std::min(mn, l_mn[l]);
+                sum += l_sum[l];
+                sq += l_sq[l];
+            }
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        if (n >= 4) {
+            float32x4_t v_mx = vld1q_f32(r), v_mn = v_mx;
+            float32x4_t v_sum = vdupq_n_f32(0), v_sq = vdupq_n_f32(0);
+            for (; i + 4 <= n; i += 4) {
+                float32x4_t v = vld1q_f32(r + i);
+                v_mx = vmaxq_f32(v_mx, v);
+                v_mn = vminq_f32(v_mn, v);
+                v_sum = vaddq_f32(v_sum, v);
+                v_sq = vmlaq_f32(v_sq, v, v);
+            }
+            mx = vmaxvq_f32(v_mx);
+            mn = vminvq_f32(v_mn);
+            sum = vaddvq_f32(v_sum);
+            sq = vaddvq_f32(v_sq);
+        }
+#endif
+
+        for (; i < n; i++) {
+            mx = std::max(mx, r[i]);
+            mn = std::min(mn, r[i]);
+            sum += r[i];
+            sq += r[i] * r[i];
+        }
+    }
+}
+
+void analyzeResponse(const float* res, int rows, int cols, responseStats& st)
+{
+    static thread_local std::vector<float> row_max;
+    row_max.resize(rows);
+
+    double sum = 0, sq = 0;
+    int max_row = 0, min_row = 0;
+    st.max_val = -FLT_MAX;
+    st.min_val = FLT_MAX;
+
+    // The pass over the map: per row statistics, the extreme rows remembered
+    for (int y = 0; y < rows; y++) {
+        float r_mx, r_mn, r_sum, r_sq;
+        rowStats(res + y * cols, cols, r_mx, r_mn, r_sum, r_sq);
+
+        row_max[y] = r_mx;
+        sum += r_sum;
+        sq += r_sq;
+        if (r_mx > st.max_val) {
+            st.max_val = r_mx;
+            max_row = y;
+        }
+        if (r_mn < st.min_val) {
+            st.min_val = r_mn;
+            min_row = y;
+        }
+    }
+
+    // Locate the extremes within their rows
+    const float* r = res + max_row * cols;
+    st.max_y = max_row;
+    st.max_x = (int) (std::find(r, r + cols, st.max_val) - r);
+    r = res + min_row * cols;
+    st.min_y = min_row;
+    st.min_x = (int) (std::find(r, r + cols, st.min_val) - r);
+
+    // sum (v - min)^2 = sum v^2 - 2 min sum v + n min^2
+    const int n = rows * cols;
+    const double mn = st.min_val;
+    st.sq_dev = std::max(sq - 2 * mn * sum + n * mn * mn, 0.0);
+    st.apce = (float) ((st.max_val - mn) * (st.max_val - mn) / (st.sq_dev / n));
+
+    // Peak window, clipped to the map
+    const int y0 = std::max(st.max_y - KCF_PSR_EXCLUDE, 0), y1 = std::min(st.max_y + KCF_PSR_EXCLUDE, rows - 1);
+    const int x0 = std::max(st.max_x - KCF_PSR_EXCLUDE, 0), x1 = std::min(st.max_x + KCF_PSR_EXCLUDE, cols - 1);
+
+    double w_sum = 0, w_sq = 0;
+    float second = -FLT_MAX;
+    for (int y = 0; y < rows; y++) {
+        if (y < y0 || y > y1) {
+            second = std::max(second, row_max[y]);
+            continue;
+        }
+        r = res + y * cols;
+        for (int x = 0; x < cols; x++) {
+            if (x < x0 || x > x1)
+                second = std::max(second, r[x]);
+            else {
+                w_sum += r[x];
+                w_sq += r[x] * r[x];
+            }
+        }
+    }
+
+    const int side_n = n - (y1 - y0 + 1) * (x1 - x0 + 1);
+    if (side_n > 0) {
+        double side_mean = (sum - w_sum) / side_n;
+        double side_var = std::max((sq - w_sq) / side_n - side_mean * side_mean, 0.0);
+        st.psr = (float) ((st.max_val - side_mean) / (std::sqrt(side_var) + 1e-6));
+        st.second_ratio = st.max_val != 0 ? second / st.max_val : 0.0f;
+    }
+    else {
+        st.psr = 0.0f;
+        st.second_ratio = 0.0f;
+    }
+}
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#ifndef _KCFKERNELS_HPP_
+#define _KCFKERNELS_HPP_
+#endif
+
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+// With template_size 96 and cell_size 4 the longer side of a HOG patch is always
+// 104 / 4 - 2 = 24 cells, and the shorter side is an even number of cells.
+#define KCF_LONG_SIDE 24
+#define KCF_HOG_CHANNELS 31
+#define KCF_LAB_CHANNELS 15
+
+// Half width of the window around the peak left out of the PSR sidelobe and the second peak
+#define KCF_PSR_EXCLUDE 2
+
+namespace KCFKernels
+{
+// Patch geometry: a feature map of ch rows, each one rows x cols cells laid out contiguously.
+struct kernelGeometry {
+    int rows;
+    int cols;
+    int ch;
+};
+
+// Element-wise stages of detection and training, all on continuous float buffers.
+struct kernelOps {
+    // feat[c][i] *= hann[i] for every channel
+    void (*window)(const kernelGeometry& g, float* feat, const float* hann);
+    // Sum of squares over all channels
+    double (*energy)(const kernelGeometry& g, const float* x);
+    // c += real part of spec (interleaved complex), with its quadrants swapped as FFTTools::rearrange does
+    void (*accumulate)(const kernelGeometry& g, float* c, const float* spec);
+    // k = exp(-max(xx + yy - 2c, 0) / numel / sigma^2), c and k may alias
+    void (*gaussian)(const kernelGeometry& g, const float* c, double xx, double yy, float sigma, float* k);
+    // dst = (1 - f) * dst + f * src over the feature map, dst and src may alias
+    void (*blendFeatures)(const kernelGeometry& g, float* dst, const float* src, float f);
+    // Same over one complex spectrum
+    void (*blendSpectrum)(const kernelGeometry& g, float* dst, const float* src, float f);
+    bool fixed;
+};
+
+// Dimensions read from the geometry at run time
+struct dynamicDims {
+    static int rows(const kernelGeometry& g) { return g.rows; }
+    static int cols(const kernelGeometry& g) { return g.cols; }
+    static int ch(const kernelGeometry& g) { return g.ch; }
+};
+
+// Dimensions known at compile time, so every loop has a constant trip count
+template <int ROWS, int COLS, int CH>
+struct fixedDims {
+    static constexpr int rows(const kernelGeometry&) { return ROWS; }
+    static constexpr int cols(const kernelGeometry&) { return COLS; }
+    static constexpr int ch(const kernelGeometry&) { return CH; }
+};
+
+template <class D>
+void window(const kernelGeometry& g, float* feat, const float* hann)
+{
+    const int n = D::rows(g) * D::cols(g);
+    for (int c = 0; c < D::ch(g); c++) {
+        float* f = feat + c * n;
+        for (int i = 0; i < n; i++)
+            f[i] *= hann[i];
+    }
+}
+
+template <class D>
+double energy(const kernelGeometry& g, const float* x)
+{
+    const int n = D::rows(g) * D::cols(g);
+    double sum = 0;
+    for (int c = 0; c < D::ch(g); c++) {
+        const float* p = x + c * n;
+        float s = 0;
+        for (int i = 0; i < n; i++)
+            s += p[i] * p[i];
+        sum += s;
+    }
+    return sum;
+}
+
+template <class D>
+void accumulate(const kernelGeometry& g, float* c, const float* spec)
+{
+    const int rows = D::rows(g), cols = D::cols(g);
+    const int cy = rows / 2, cx = cols / 2;
+    // Only the leading 2cy x 2cx block moves, an odd last row or column stays in place
+    for (int i = 0; i < 2 * cy; i++) {
+        int si = i < cy ? i + cy : i - cy;
+        float* dst = c + i * cols;
+        const float* src = spec + 2 * si * cols;
+        for (int j = 0; j < cx; j++)
+            dst[j] += src[2 * (j + cx)];
+        for (int j = cx; j < 2 * cx; j++)
+            dst[j] += src[2 * (j - cx)];
+        if (cols & 1)
+            dst[cols - 1] += spec[2 * (i * cols + cols - 1)];
+    }
+    if (rows & 1) {
+        float* dst = c + (rows - 1) * cols;
+        const float* src = spec + 2 * (rows - 1) * cols;
+        for (int j = 0; j < cols; j++)
+            dst[j] += src[2 * j];
+    }
+}
+
+template <class D>
+void gaussian(const kernelGeometry& g, const float* c, double xx, double yy, float sigma, float* k)
+{
+    const int n = D::rows(g) * D::cols(g);
+    const float sum = (float) (xx + yy);
+    const float norm = 1.f / (n * D::ch(g));
+    const float mult = -1.f / (sigma * sigma);
+    for (int i = 0; i < n; i++)
+        k[i] = std::exp(mult * std::max((sum - 2.f * c[i]) * norm, 0.f));
+}
+
+template <class D>
+void blendFeatures(const kernelGeometry& g, float* dst, const float* src, float f)
+{
+    const int n = D::rows(g) * D::cols(g) * D::ch(g);
+    for (int i = 0; i < n; i++)
+        dst[i] = (1 - f) * dst[i] + f * src[i];
+}
+
+template <class D>
+void blendSpectrum(const kernelGeometry& g, float* dst, const float* src, float f)
+{
+    const int n = D::rows(g) * D::cols(g) * 2;
+    for (int i = 0; i < n; i++)
+        dst[i] = (1 - f) * dst[i] + f * src[i];
+}
+
+template <class D>
+const kernelOps& opsFor()
+{
+    static const kernelOps ops = {window<D>, energy<D>, accumulate<D>, gaussian<D>,
+                                  blendFeatures<D>, blendSpectrum<D>, !std::is_same<D, dynamicDims>::value};
+    return ops;
+}
+
+// Specialized kernels for this geometry if one was compiled in, otherwise the generic ones.
+const kernelOps& select(const kernelGeometry& g);
+
+// Confidence statistics of one response map
+struct responseStats {
+    float max_val;
+    float min_val;
+    int max_x, max_y; // first maximum in row-major order
+    int min_x, min_y;
+    double sq_dev;      // sum of squared deviations from the minimum
+    float apce;         // (max - min)^2 / mean squared deviation
+    float psr;          // (max - sidelobe mean) / sidelobe deviation, the sidelobe excluding the peak window
+    float second_ratio; // highest value outside the peak window over the maximum
+};
+
+// All statistics from one vectorized pass over the map, plus the peak window
+void analyzeResponse(const float* res, int rows, int cols, responseStats& st);
+}
@@ -10,6 +10,9 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
@@ -19,8 +22,22 @@
 #include <dirent.h>
 
 // Constructor
-KCFTracker::KCFTracker(bool hog, bool fixed_window, bool multiscale, bool lab)
+KCFTracker::KCFTracker(bool hog, bool fixed_window, bool multiscale, bool lab, bool linear)
 {
+    _cfg[0] = hog;
+    _cfg[1] = fixed_window;
+    _cfg[2] = multiscale;
+    _cfg[3] = lab;
+    _cfg[4] = linear;
+    _linear = linear;
+
+    model_precision = QMAT_FLOAT32;
+
+    _response = KCFKernels::responseStats();
+
+    // Selected once the first patch fixes the geometry
+    _geom = {0, 0, 0};
+    _kernels = nullptr;
 
     // Parameters equal in all cases
     lambda = 0.0001;
@@ -65,11 +82,23 @@ KCFTracker::KCFTracker(bool hog, bool fixed_window, bool multiscale, bool lab)
     }
 
 
+    // Scale filter, used with multiscale
+    n_scales = 17;
+    scale_sigma_factor = 0.25;
+    scale_lambda = 0.01;
+    scale_interp_factor = 0.025;
+    scale_model_area = 256;
+
+    // Change-gated training, off unless train_similarity is lowered
+    train_similarity = 1;
+    train_max_skip = 4;
+    _similarity = 0;
+    _skipped = 0;
+
     if (multiscale) { // multiscale
         template_size = 96;
         //template_size = 100;
-        scale_step = 1.05;
-        scale_weight = 0.95;
+        scale_step = 1.02;
         if (!fixed_window) {
             //printf("Multiscale does not support non-fixed window.\n");
             fixed_window = true;
@@ -97,12 +126,55 @@ void KCFTracker::init(const cv::Rect &roi, cv::Mat image)
     //_num = cv::Mat(size_patch[0], size_patch[1], CV_32FC2, float(0));
     //_den = cv::Mat(size_patch[0], size_patch[1], CV_32FC2, float(0));
     train(_tmpl, 1.0); // train with initial frame
+    initScale(image);
+    _skipped = 0;
  }
 
+// Initialize tracker on a new target, reusing buffers when the template geometry matches
+void KCFTracker::reinit(const cv::Rect &roi, cv::Mat image)
+{
+    if (_tmpl.empty() && _qtmpl.empty()) {
+        init(roi, image);
+        return;
+    }
+
+    int old_patch[3] = {size_patch[0], size_patch[1], size_patch[2]};
+
+    _roi = roi;
+    assert(roi.width >= 0 && roi.height >= 0);
+    cv::Mat x = getFeatures(image, 1);
+
+    if (size_patch[0] == old_patch[0] && size_patch[1] == old_patch[1] && size_patch[2] == old_patch[2]) {
+        // Same geometry: _prob and the Hanning window still apply, and _tmpl keeps its buffer.
+        // _alphaf is fully overwritten by training with factor 1.
+        x.copyTo(_tmpl);
+    }
+    else {
+        _tmpl = x;
+        _prob = createGaussianPeak(size_patch[0], size_patch[1]);
+        _alphaf = cv::Mat(size_patch[0], size_patch[1], CV_32FC2, float(0));
+    }
+    train(_tmpl, 1.0); // train with initial frame
+    initScale(image);
+    _skipped = 0;
+}
+
+// Whether the tracker was constructed with these flags
+bool KCFTracker::isConfigured(bool hog, bool fixed_window, bool multiscale, bool lab, bool linear) const
+{
+    return _cfg[0] == hog && _cfg[1] == fixed_window && _cfg[2] == multiscale && _cfg[3] == lab
+        && _cfg[4] == linear;
+}
+
 
  cv::Mat KCFTracker::getTmpl(){
 
-    return _tmpl;
+    if (!_tmpl.empty())
+        return _tmpl;
+
+    cv::Mat tmpl;
+    _qtmpl.load(tmpl);
+    return tmpl;
  }
 
 bool KCFTracker::getRoiFeature(const cv::Rect &roi, cv::Mat image, cv::Mat& appearance) {
@@ -117,7 +189,8 @@ bool KCFTracker::getRoiFeature(const cv::Rect &roi, cv::Mat image, cv::Mat& appe
 
 // Update position based on the new frame
 cv::Rect KCFTracker::update(cv::Mat image, float beta_1, float beta_2, float alpha_apce, float& peak_value,  
-    float& mean_peak_value, float& mean_apce_value, float& current_apce_value, bool& apce_accepted)
+    float& mean_peak_value, float& mean_apce_value, float& current_apce_value, bool& apce_accepted,
+    bool full)
 {
     if (_roi.x + _roi.width <= 0) _roi.x = -_roi.width + 1;
     if (_roi.y + _roi.height <= 0) _roi.y = -_roi.height + 1;
@@ -132,76 +205,91 @@ cv::Rect KCFTracker::update(cv::Mat image, float beta_1, float beta_2, float alp
     cv::Point2f res = detect(_tmpl, getFeatures(image, 0, 1.0f), peak_value, beta_1, beta_2, 
             alpha_apce, mean_peak_value, mean_apce_value, current_apce_value, apce_accepted);
 
-    if (scale_step != 1) {
-        // Test at a smaller _scale
-        float new_peak_value;
-        float new_mean_peak_value, new_mean_apce_value, new_current_apce_value;
-        bool new_apce_accepted;
-
-        
+// Adjust by cell size and _scale
 
-        cv::Point2f new_res = detect(_tmpl, getFeatures(image, 0, 1.0f / scale_step), new_peak_value,
-            beta_1, beta_2, alpha_apce, new_mean_peak_value, new_mean_apce_value, new_current_apce_value, new_apce_accepted);
+    _roi.x = cx - _roi.width / 2.0f + ((float) res.x * cell_size * _scale);
+    _roi.y = cy - _roi.height / 2.0f + ((float) res.y * cell_size * _scale);
 
-        if (scale_weight * new_peak_value > peak_value) {
+    if (_roi.x >= image.cols - 1) _roi.x = image.cols - 1;
+    if (_roi.y >= image.rows - 1) _roi.y = image.rows - 1;
+    if (_roi.x + _roi.width <= 0) _roi.x = -_roi.width + 2;
+    if (_roi.y + _roi.height <= 0) _roi.y = -_roi.height + 2;
 
-            res = new_res;
-            _scale /= scale_step;
-            _roi.width /= scale_step;
-            _roi.height /= scale_step;
+    assert(_roi.width >= 0 && _roi.height >= 0);
 
-            peak_value = new_peak_value;
-            mean_peak_value = new_mean_peak_value;
-            mean_apce_value = new_mean_apce_value;
-            current_apce_value = new_current_apce_value;
-            apce_accepted = new_apce_accepted;
-        }
+    // Scale, estimated at the new position by the 1-D filter
+    if (scale_step != 1 && full) {
+        float factor = detectScale(image);
+        factor = std::min(std::max(_scale * factor, _scale_min), _scale_max) / _scale;
 
-        // Test at a bigger _scale
-        new_res = detect(_tmpl, getFeatures(image, 0, scale_step), new_peak_value, beta_1, beta_2, 
-            alpha_apce, new_mean_peak_value, new_mean_apce_value, new_current_apce_value, new_apce_accepted);
+        float ncx = _roi.x + _roi.width / 2.0f;
+        float ncy = _roi.y + _roi.height / 2.0f;
 
+        _scale *= factor;
+        _roi.width *= factor;
+        _roi.height *= factor;
+        _roi.x = ncx - _roi.width / 2.0f;
+        _roi.y = ncy - _roi.height / 2.0f;
+    }
 
-        if (scale_weight * new_peak_value > peak_value) {
 
-            res = new_res;
-            _scale *= scale_step;
-            _roi.width *= scale_step;
-            _roi.height *= scale_step;
+    /* APCE. Translation-only updates leave the model untouched. */
+    if(apce_accepted == true && full){
 
-            peak_value = new_peak_value;
-            mean_peak_value = new_mean_peak_value;
-            mean_apce_value = new_mean_apce_value;
-            current_apce_value = new_current_apce_value;
-            apce_accepted = new_apce_accepted;
+        // Change gating. While the target still matches the template, training waits, and the next
+        // one blends with the weight the skipped frames would have had together.
+        if (_similarity > train_similarity && _skipped < train_max_skip) {
+            _skipped++;
+        }
+        else {
+            float factor = 1 - std::pow(1 - interp_factor, (float) (_skipped + 1));
+            cv::Mat x = getFeatures(image, 0);
+            train(x, factor);
+            _skipped = 0;
         }
+
+        if (scale_step != 1)
+            trainScale(image, scale_interp_factor);
     }
 
-// Adjust by cell size and _scale
 
-    _roi.x = cx - _roi.width / 2.0f + ((float) res.x * cell_size * _scale);
-    _roi.y = cy - _roi.height / 2.0f + ((float) res.y * cell_size * _scale);
-
-    if (_roi.x >= image.cols - 1) _roi.x = image.cols - 1;
-    if (_roi.y >= image.rows - 1) _roi.y = image.rows - 1;
-    if (_roi.x + _roi.width <= 0) _roi.x = -_roi.width + 2;
-    if (_roi.y + _roi.height <= 0) _roi.y = -_roi.height + 2;
+    return _roi;
+}
 
-    assert(_roi.width >= 0 && _roi.height >= 0);
 
+// Estimated cost of an update, in feature elements processed
+float KCFTracker::getUpdateCost(bool full) const
+{
+    float patch = (float) size_patch[0] * size_patch[1] * size_patch[2];
 
-    cv::Mat x = getFeatures(image, 0);
+    if (!full)
+        return patch;
 
-    /* APCE. */
-    if(apce_accepted == true){
+    // One detection, plus feature extraction and training
+    float cost = patch * 2;
 
-        train(x, interp_factor);
-    }
+    // The scale filter samples, detects and trains on n_scales compact patches
+    if (scale_step != 1)
+        cost += (float) _scale_model_sz.area() * n_scales * 2;
 
+    return cost;
+}
 
-    return _roi;
+// Confidence statistics of the response map of the last update
+const KCFKernels::responseStats& KCFTracker::getResponseStats() const
+{
+    return _response;
 }
 
+// Move the target to the center of roi, keeping the trained model and scale
+void KCFTracker::relocate(const cv::Rect &roi)
+{
+    float cx = roi.x + roi.width / 2.0f;
+    float cy = roi.y + roi.height / 2.0f;
+
+    _roi.x = cx - _roi.width / 2.0f;
+    _roi.y = cy - _roi.height / 2.0f;
+}
 
 // Detect object in the current frame.
 cv::Point2f KCFTracker::detect(cv::Mat z, cv::Mat x, float &peak_value, float beta_1, float beta_2, 
@@ -210,31 +298,25 @@ cv::Point2f KCFTracker::detect(cv::Mat z, cv::Mat x, float &peak_value, float be
 {
     using namespace FFTTools;
 
-    cv::Mat k = gaussianCorrelation(x, z);
-    cv::Mat res = (real(fftd(complexMultiplication(_alphaf, fftd(k)), true)));
+    kernelSpectrum(x, z, _spec[0]);
+    complexMultiply(model(), _spec[0], _spec[0]);
+    fftd(_spec[0], _spec[0], true);
 
-    //minMaxLoc only accepts doubles for the peak, and integer points for the coordinates
-    cv::Point2i pi;
-    double maxVal,minVal;
-    /* cv::minMaxLoc(InputArray src, double* minVal, double* maxVal, Point* minLoc, Point* maxLoc) */
-    cv::minMaxLoc(res, &minVal, &maxVal, NULL, &pi);
+    cv::Mat res;
+    cv::extractChannel(_spec[0], res, 0);
+
+    // Peak, APCE and the other confidence statistics in one pass
+    KCFKernels::analyzeResponse((const float*) res.data, res.rows, res.cols, _response);
+
+    cv::Point2i pi(_response.max_x, _response.max_y);
+    double maxVal = _response.max_val;
     peak_value = (float) maxVal;
 
     //subpixel peak estimation, coordinates will be non-integer
     cv::Point2f p((float)pi.x, (float)pi.y);
 
-    double diff,mean_diff;
-    double diff_sum = 0;
-    for(int x=0; x<res.cols; ++x){
-        for(int y=0; y<res.rows; ++y){
-            diff = res.at<float>(y,x) - minVal;
-            diff_sum += std::pow(diff,2);
-        }
-    }
-    mean_diff = diff_sum/(res.cols*res.rows);
-
     /* APCE. */
-    current_apce_value = std::pow((maxVal-minVal),2)/mean_diff;
+    current_apce_value = _response.apce;
 
     if(maxVal > beta_1 * mean_peak_value && current_apce_value > beta_2 * mean_apce_value){
 
@@ -269,11 +351,30 @@ void KCFTracker::train(cv::Mat x, float train_interp_factor)
 {
     using namespace FFTTools;
 
-    cv::Mat k = gaussianCorrelation(x, x);
-    cv::Mat alphaf = complexDivision(_prob, (fftd(k) + lambda));
+    kernelSpectrum(x, x, _spec[0]);
+    _spec[0] += cv::Scalar(lambda);
+    cv::Mat alphaf = _spec[1];
+    complexDivide(_prob, _spec[0], alphaf);
     
-    _tmpl = (1 - train_interp_factor) * _tmpl + (train_interp_factor) * x;
-    _alphaf = (1 - train_interp_factor) * _alphaf + (train_interp_factor) * alphaf;
+    // Packed models are blended in float with their rounding error added back, then packed again
+    static thread_local cv::Mat tmpl_buf, model_buf;
+    if (_tmpl.empty())
+        _qtmpl.loadForUpdate(tmpl_buf);
+    if (_alphaf.empty())
+        _qalphaf.loadForUpdate(model_buf);
+    cv::Mat tmpl = _tmpl.empty() ? tmpl_buf : _tmpl;
+    cv::Mat model_f = _alphaf.empty() ? model_buf : _alphaf;
+
+    // Blend in place, _tmpl may be x itself on the first frame
+    _kernels->blendFeatures(_geom, (float*) tmpl.data, (const float*) x.data, train_interp_factor);
+    _kernels->blendSpectrum(_geom, (float*) model_f.data, (const float*) alphaf.data, train_interp_factor);
+
+    if (model_precision != QMAT_FLOAT32) {
+        _qtmpl.store(tmpl, model_precision, size_patch[2]);
+        _qalphaf.store(model_f, model_precision, size_patch[0]);
+        _tmpl.release();
+        _alphaf.release();
+    }
 
 
     /*cv::Mat kf = fftd(gaussianCorrelation(x, x));
@@ -288,52 +389,172 @@ void KCFTracker::train(cv::Mat x, float train_interp_factor)
 
 }
 
-// Evaluates a Gaussian kernel with bandwidth SIGMA for all relative shifts between input images X and Y, which must both be MxN. They must    also be periodic (ie., pre-processed with a cosine window).
-cv::Mat KCFTracker::gaussianCorrelation(cv::Mat x1, cv::Mat x2)
+// Cross-correlation of X and Y summed over channels, for all relative shifts, rearranged like the response.
+cv::Mat KCFTracker::crossCorrelation(cv::Mat x1, cv::Mat x2, double& xx, double& yy)
 {
     using namespace FFTTools;
     cv::Mat c = cv::Mat( cv::Size(size_patch[1], size_patch[0]), CV_32F, cv::Scalar(0) );
-    // HOG features
-    if (_hogfeatures) {
-        cv::Mat caux;
-        cv::Mat x1aux;
-        cv::Mat x2aux;
-        for (int i = 0; i < size_patch[2]; i++) {
-            x1aux = x1.row(i);   // Procedure do deal with cv::Mat multichannel bug
-            x1aux = x1aux.reshape(1, size_patch[0]);
-            x2aux = x2.row(i).reshape(1, size_patch[0]);
-            cv::mulSpectrums(fftd(x1aux), fftd(x2aux), caux, 0, true); 
-            caux = fftd(caux, true);
-            rearrange(caux);
-            caux.convertTo(caux,CV_32F);
-            c = c + real(caux);
+    bool same = x1.data == x2.data;
+
+    // The inverse transform is linear, so the cross spectra of all channels are summed first
+    crossSpectrum(x1, x2);
+    fftd(_spec[2], _spec[2], true);
+    // Rearranged real part, added to c
+    _kernels->accumulate(_geom, (float*) c.data, (const float*) _spec[2].data);
+
+    energies(x1, x2, xx, yy);
+
+    // How much the target changed since the template, for change-gated training
+    if (!same) {
+        double max_c;
+        cv::minMaxLoc(c, NULL, &max_c);
+        _similarity = (xx > 0 && yy > 0) ? (float) (max_c / std::sqrt(xx * yy)) : 0.f;
+    }
+
+    return c;
+}
+
+// Cross spectrum of X and Y summed over channels, into _spec[2]. _spec[0] and _spec[1] are scratch.
+void KCFTracker::crossSpectrum(cv::Mat x1, cv::Mat x2)
+{
+    using namespace FFTTools;
+    // x2 is transformed once when it is x1
+    bool same = x1.data == x2.data;
+    static thread_local cv::Mat row_buf;
+
+    _spec[2].create(size_patch[0], size_patch[1], CV_32FC2);
+    _spec[2].setTo(cv::Scalar::all(0));
+    for (int i = 0; i < size_patch[2]; i++) {
+        fftd(channel(x1, i, row_buf), _spec[0]);
+        if (!same)
+            fftd(channel(x2, i, row_buf), _spec[1]);
+        complexMultiplyAdd(_spec[0], same ? _spec[0] : _spec[1], _spec[2], true);
+    }
+}
+
+// Energies of X and Y. An empty input is the packed template.
+void KCFTracker::energies(cv::Mat x1, cv::Mat x2, double& xx, double& yy)
+{
+    xx = x1.empty() ? _qtmpl.energy() : _kernels->energy(_geom, (const float*) x1.data);
+    yy = x1.data == x2.data ? xx : x2.empty() ? _qtmpl.energy() : _kernels->energy(_geom, (const float*) x2.data);
+}
+
+// Spectrum of the kernel between X and Y, the same as fftd(correlation(x1, x2)).
+void KCFTracker::kernelSpectrum(cv::Mat x1, cv::Mat x2, cv::Mat& kf)
+{
+    using namespace FFTTools;
+
+    // The rearrangement is a circular shift by half the patch only when both sides are even
+    if (!_linear || (size_patch[0] & 1) || (size_patch[1] & 1)) {
+        fftd(correlation(x1, x2), kf);
+        return;
+    }
+
+    // The linear kernel is the cross-correlation itself, so its spectrum is the summed cross
+    // spectrum and no transform is needed. The spatial peak is only inverted for change gating.
+    crossSpectrum(x1, x2);
+    if (x1.data != x2.data && train_similarity < 1) {
+        static thread_local cv::Mat re_buf;
+        double xx, yy, max_c;
+        fftd(_spec[2], _spec[1], true);
+        // The rearrangement doesn't move the maximum
+        cv::extractChannel(_spec[1], re_buf, 0);
+        cv::minMaxLoc(re_buf, NULL, &max_c);
+        energies(x1, x2, xx, yy);
+        _similarity = (xx > 0 && yy > 0) ? (float) (max_c / std::sqrt(xx * yy)) : 0.f;
+    }
+
+    // A half-patch shift multiplies bin (u, v) by (-1)^(u + v), folded into the kernel normalization
+    const float norm = 1.f / (size_patch[0] * size_patch[1] * size_patch[2]);
+    kf.create(size_patch[0], size_patch[1], CV_32FC2);
+    for (int i = 0; i < size_patch[0]; i++) {
+        const float* s = _spec[2].ptr<float>(i);
+        float* d = kf.ptr<float>(i);
+        float f = (i & 1) ? -norm : norm;
+        for (int j = 0; j < size_patch[1]; j++, f = -f) {
+            d[2 * j] = f * s[2 * j];
+            d[2 * j + 1] = f * s[2 * j + 1];
         }
     }
-    // Gray features
-    else {
-        cv::mulSpectrums(fftd(x1), fftd(x2), c, 0, true);
-        c = fftd(c, true);
-        rearrange(c);
-        c = real(c);
+}
+
+// Evaluates a Gaussian kernel with bandwidth SIGMA for all relative shifts between input images X and Y, which must both be MxN. They must    also be periodic (ie., pre-processed with a cosine window).
+cv::Mat KCFTracker::gaussianCorrelation(cv::Mat x1, cv::Mat x2)
+{
+    double xx, yy;
+    cv::Mat c = crossCorrelation(x1, x2, xx, yy);
+
+    // Gaussian kernel computed in place
+    _kernels->gaussian(_geom, (const float*) c.data, xx, yy, sigma, (float*) c.data);
+    return c;
+}
+
+// Linear kernel for all relative shifts between input images X and Y, which must both be MxN.
+cv::Mat KCFTracker::linearCorrelation(cv::Mat x1, cv::Mat x2)
+{
+    double xx, yy;
+    cv::Mat c = crossCorrelation(x1, x2, xx, yy);
+
+    c *= 1.f / (size_patch[0] * size_patch[1] * size_patch[2]);
+    return c;
+}
+
+cv::Mat KCFTracker::correlation(cv::Mat x1, cv::Mat x2)
+{
+    return _linear ? linearCorrelation(x1, x2) : gaussianCorrelation(x1, x2);
+}
+
+// Channel i of x as a patch, dequantized from _qtmpl into buf when x is the packed template (empty)
+cv::Mat KCFTracker::channel(cv::Mat x, int i, cv::Mat& buf)
+{
+    if (x.empty()) {
+        _qtmpl.loadRow(i, buf);
+        return buf.reshape(1, size_patch[0]);
     }
-    cv::Mat d; 
-    cv::max(( (cv::sum(x1.mul(x1))[0] + cv::sum(x2.mul(x2))[0])- 2. * c)/\
-     (size_patch[0]*size_patch[1]*size_patch[2])  , 0, d);
+    // One channel per row, gray patches included
+    return x.reshape(1, size_patch[2]).row(i).reshape(1, size_patch[0]);   // Procedure do deal with cv::Mat multichannel bug
+}
 
-    cv::Mat k;
-    cv::exp((-d / (sigma * sigma)), k);
-    return k;
+// Model spectrum in float, dequantized when stored packed
+cv::Mat KCFTracker::model()
+{
+    if (!_alphaf.empty())
+        return _alphaf;
+
+    static thread_local cv::Mat buf;
+    _qalphaf.load(buf);
+    return buf;
 }
 
 // Create Gaussian Peak. Function called only in the first frame.
 cv::Mat KCFTracker::createGaussianPeak(int sizey, int sizex)
 {
+    float output_sigma = std::sqrt((float) sizex * sizey) / padding * output_sigma_factor;
+
+    return sharedGaussianPeak(sizey, sizex, output_sigma);
+}
+
+// Trackers of the same template geometry share their label spectrum and Hanning window.
+// Entries are never written after insertion, so the returned headers can be used without the lock.
+namespace {
+    std::mutex cache_mutex;
+    std::map<std::pair<int, int>, cv::Mat> hanning_cache;
+    std::map<std::tuple<int, int, float>, cv::Mat> gaussian_cache;
+}
+
+cv::Mat KCFTracker::sharedGaussianPeak(int sizey, int sizex, float output_sigma)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    cv::Mat& cached = gaussian_cache[std::make_tuple(sizey, sizex, output_sigma)];
+    if (!cached.empty())
+        return cached;
+
     cv::Mat_<float> res(sizey, sizex);
 
     int syh = (sizey) / 2;
     int sxh = (sizex) / 2;
 
-    float output_sigma = std::sqrt((float) sizex * sizey) / padding * output_sigma_factor;
     float mult = -0.5 / (output_sigma * output_sigma);
 
     for (int i = 0; i < sizey; i++)
@@ -343,7 +564,28 @@ cv::Mat KCFTracker::createGaussianPeak(int sizey, int sizex)
             int jh = j - sxh;
             res(i, j) = std::exp(mult * (float) (ih * ih + jh * jh));
         }
-    return FFTTools::fftd(res);
+    cached = FFTTools::fftd(res);
+    return cached;
+}
+
+cv::Mat KCFTracker::sharedHanning(int rows, int cols)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    cv::Mat& cached = hanning_cache[std::make_pair(rows, cols)];
+    if (!cached.empty())
+        return cached;
+
+    cv::Mat hann1t = cv::Mat(cv::Size(cols,1), CV_32F, cv::Scalar(0));
+    cv::Mat hann2t = cv::Mat(cv::Size(1,rows), CV_32F, cv::Scalar(0)); 
+
+    for (int i = 0; i < hann1t.cols; i++)
+        hann1t.at<float > (0, i) = 0.5 * (1 - std::cos(2 * 3.14159265358979323846 * i / (hann1t.cols - 1)));
+    for (int i = 0; i < hann2t.rows; i++)
+        hann2t.at<float > (i, 0) = 0.5 * (1 - std::cos(2 * 3.14159265358979323846 * i / (hann2t.rows - 1)));
+
+    cached = hann2t * hann1t;
+    return cached;
 }
 
 // Obtain sub-window from image, with replication-padding and extract features
@@ -487,10 +729,17 @@ cv::Mat KCFTracker::getFeatures(const cv::Mat & image, bool inithann, float scal
     }
     
     if (inithann) {
-        createHanningMats();
+        // Keep the window and kernels when the patch geometry is unchanged
+        if (hann.rows != size_patch[0] || hann.cols != size_patch[1] || _geom.ch != size_patch[2]) {
+            createHanningMats();
+            _geom = {size_patch[0], size_patch[1], size_patch[2]};
+            _kernels = &KCFKernels::select(_geom);
+        }
     }
 
-    FeaturesMap = hann.mul(FeaturesMap);
+    // One window for all channels, applied in place
+    assert(FeaturesMap.isContinuous());
+    _kernels->window(_geom, (float*) FeaturesMap.data, (const float*) hann.data);
 
     // std:: cout << "DONE" << std::endl;
     
@@ -500,32 +749,122 @@ cv::Mat KCFTracker::getFeatures(const cv::Mat & image, bool inithann, float scal
 // Initialize Hanning window. Function called only in the first frame.
 void KCFTracker::createHanningMats()
 {   
-    cv::Mat hann1t = cv::Mat(cv::Size(size_patch[1],1), CV_32F, cv::Scalar(0));
-    cv::Mat hann2t = cv::Mat(cv::Size(1,size_patch[0]), CV_32F, cv::Scalar(0)); 
+    hann = sharedHanning(size_patch[0], size_patch[1]);
+}
 
-    for (int i = 0; i < hann1t.cols; i++)
-        hann1t.at<float > (0, i) = 0.5 * (1 - std::cos(2 * 3.14159265358979323846 * i / (hann1t.cols - 1)));
-    for (int i = 0; i < hann2t.rows; i++)
-        hann2t.at<float > (i, 0) = 0.5 * (1 - std::cos(2 * 3.14159265358979323846 * i / (hann2t.rows - 1)));
+// 1-D scale filter (DSST): labels, window and model size for the current target. Trains with factor 1.
+void KCFTracker::initScale(const cv::Mat& image)
+{
+    if (scale_step == 1)
+        return;
+
+    int center = n_scales / 2;
+    float scale_sigma = std::sqrt((float) n_scales) * scale_sigma_factor;
+
+    cv::Mat ys(1, n_scales, CV_32F);
+    _scale_factors.resize(n_scales);
+    _scale_hann.resize(n_scales);
+    for (int i = 0; i < n_scales; i++) {
+        int ss = i - center;
+        ys.at<float>(0, i) = std::exp(-0.5f * ss * ss / (scale_sigma * scale_sigma));
+        _scale_factors[i] = std::pow(scale_step, (float) ss);
+        _scale_hann[i] = 0.5 * (1 - std::cos(2 * 3.14159265358979323846 * i / (n_scales - 1)));
+    }
+    cv::dft(ys, _scale_prob, cv::DFT_COMPLEX_OUTPUT);
 
-    cv::Mat hann2d = hann2t * hann1t;
-    // HOG features
-    if (_hogfeatures) {
-        cv::Mat hann1d = hann2d.reshape(1,1); // Procedure do deal with cv::Mat multichannel bug
-        
-        hann = cv::Mat(cv::Size(size_patch[0]*size_patch[1], size_patch[2]), CV_32F, cv::Scalar(0));
-        for (int i = 0; i < size_patch[2]; i++) {
-            for (int j = 0; j<size_patch[0]*size_patch[1]; j++) {
-                hann.at<float>(i,j) = hann1d.at<float>(0,j);
-            }
-        }
+    // Samples keep the target aspect ratio at a fixed, small area
+    float s = std::sqrt(scale_model_area / std::max(_roi.width * _roi.height, 1.0f));
+    _scale_model_sz.width = std::max(1, (int) std::round(_roi.width * s));
+    _scale_model_sz.height = std::max(1, (int) std::round(_roi.height * s));
+
+    _scale_min = _scale * 0.25f;
+    _scale_max = _scale * 4.0f;
+
+    _scale_num.release();
+    trainScale(image, 1.0);
+}
+
+// Compact features of the target at every sampled scale, one column per scale
+cv::Mat KCFTracker::getScaleSample(const cv::Mat& image)
+{
+    int d = _scale_model_sz.area();
+    cv::Mat xs(d, n_scales, CV_32F);
+
+    float cx = _roi.x + _roi.width / 2.0f;
+    float cy = _roi.y + _roi.height / 2.0f;
+
+    cv::Mat patch;
+    for (int i = 0; i < n_scales; i++) {
+        cv::Rect extracted_roi;
+        extracted_roi.width = std::max(2, (int) (_roi.width * _scale_factors[i]));
+        extracted_roi.height = std::max(2, (int) (_roi.height * _scale_factors[i]));
+        extracted_roi.x = cx - extracted_roi.width / 2;
+        extracted_roi.y = cy - extracted_roi.height / 2;
+
+        patch = RectTools::subwindow(image, extracted_roi, cv::BORDER_REPLICATE);
+        cv::resize(patch, patch, _scale_model_sz, 0, 0, cv::INTER_AREA);
+        patch = RectTools::getGrayImage(patch);
+        patch -= (float) 0.5;
+
+        // Windowed along the scales
+        cv::Mat col = xs.col(i);
+        patch.reshape(1, d).convertTo(col, CV_32F, _scale_hann[i]);
+    }
+    return xs;
+}
+
+// train the scale filter at the current position and size
+void KCFTracker::trainScale(const cv::Mat& image, float train_interp_factor)
+{
+    using namespace FFTTools;
+
+    cv::Mat xsf;
+    cv::dft(getScaleSample(image), xsf, cv::DFT_ROWS | cv::DFT_COMPLEX_OUTPUT);
+
+    // num = G * conj(X) per feature, den = sum of |X|^2 over features
+    cv::Mat num(xsf.size(), CV_32FC2);
+    cv::Mat den = cv::Mat::zeros(1, n_scales, CV_32FC2);
+    for (int r = 0; r < xsf.rows; r++) {
+        cv::Mat num_r = num.row(r);
+        complexMultiply(_scale_prob, xsf.row(r), num_r, true);
+        complexMultiplyAdd(xsf.row(r), xsf.row(r), den, true);
+    }
+
+    if (_scale_num.empty() || train_interp_factor == 1) {
+        _scale_num = num;
+        _scale_den = den;
     }
-    // Gray features
     else {
-        hann = hann2d;
+        cv::addWeighted(_scale_num, 1 - train_interp_factor, num, train_interp_factor, 0, _scale_num);
+        cv::addWeighted(_scale_den, 1 - train_interp_factor, den, train_interp_factor, 0, _scale_den);
     }
 }
 
+// Scale change of the target at the current position, one of the sampled scale factors
+float KCFTracker::detectScale(const cv::Mat& image)
+{
+    using namespace FFTTools;
+
+    cv::Mat zsf;
+    cv::dft(getScaleSample(image), zsf, cv::DFT_ROWS | cv::DFT_COMPLEX_OUTPUT);
+
+    cv::Mat acc = cv::Mat::zeros(1, n_scales, CV_32FC2);
+    for (int r = 0; r < zsf.rows; r++)
+        complexMultiplyAdd(_scale_num.row(r), zsf.row(r), acc);
+
+    cv::Mat den = _scale_den + cv::Scalar(scale_lambda);
+    complexDivide(acc, den, acc);
+    cv::dft(acc, acc, cv::DFT_INVERSE | cv::DFT_SCALE);
+
+    cv::Mat response;
+    cv::extractChannel(acc, response, 0);
+
+    cv::Point2i pi;
+    cv::minMaxLoc(response, NULL, NULL, NULL, &pi);
+
+    return _scale_factors[pi.x];
+}
+
 // Calculate sub-pixel peak for one dimension
 float KCFTracker::subPixelPeak(float left, float center, float right)
 {   
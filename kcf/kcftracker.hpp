@@ -2,6 +2,8 @@
 #pragma once
 
 #include "tracker.h"
+#include "kcfkernels.hpp"
+#include "quantmat.hpp"
 
 #ifndef _OPENCV_KCFTRACKER_HPP_
 #define _OPENCV_KCFTRACKER_HPP_
@@ -11,13 +13,31 @@ class KCFTracker : public Tracker
 {
 public:
     // Constructor
-    KCFTracker(bool hog, bool fixed_window, bool multiscale, bool lab);
+    // A linear kernel skips the energy sums and the exponential of the Gaussian kernel
+    KCFTracker(bool hog, bool fixed_window, bool multiscale, bool lab, bool linear = false);
     // Initialize tracker 
     virtual void init(const cv::Rect &roi, cv::Mat image);
+
+    // Initialize tracker on a new target, reusing buffers when the template geometry matches
+    void reinit(const cv::Rect &roi, cv::Mat image);
+
+    // Whether the tracker was constructed with these flags
+    bool isConfigured(bool hog, bool fixed_window, bool multiscale, bool lab, bool linear = false) const;
     
     // Update position based on the new frame
+    // Full update searches scales and trains, otherwise only translation is estimated
     virtual cv::Rect update(cv::Mat image, float beta_1, float beta_2, float alpha_apce, float& peak_value,  
-        float& mean_peak_value, float& mean_apce_value, float& current_apce_value, bool& apce_accepted);
+        float& mean_peak_value, float& mean_apce_value, float& current_apce_value, bool& apce_accepted,
+        bool full = true);
+
+    // Estimated cost of an update, in feature elements processed
+    float getUpdateCost(bool full) const;
+
+    // Confidence statistics of the response map of the last update
+    const KCFKernels::responseStats& getResponseStats() const;
+
+    // Move the target to the center of roi, keeping the trained model and scale
+    void relocate(const cv::Rect &roi);
 
     float interp_factor; // linear interpolation factor for adaptation
     float sigma; // gaussian kernel bandwidth
@@ -27,8 +47,15 @@ public:
     float padding; // extra area surrounding the target
     float output_sigma_factor; // bandwidth of gaussian target
     int template_size; // template size
-    float scale_step; // scale step for multi-scale estimation
-    float scale_weight;  // to downweight detection scores of other scales for added stability
+    float scale_step; // scale step between the samples of the scale filter, 1 disables scale estimation
+    int n_scales; // number of scales sampled by the scale filter, odd
+    float scale_sigma_factor; // bandwidth of gaussian scale label
+    float scale_lambda; // regularization of the scale filter
+    float scale_interp_factor; // linear interpolation factor for adaptation of the scale filter
+    int scale_model_area; // pixels of the resized patches scale features are taken from
+    int model_precision; // storage of the template and model: QMAT_FLOAT32, QMAT_FLOAT16 or QMAT_INT8, set before init
+    float train_similarity; // training is deferred while the detected features match the template above this, 1 never defers
+    int train_max_skip; // deferred trainings in a row before one is forced
 
     bool getRoiFeature(const cv::Rect &roi, cv::Mat image, cv::Mat& appearance);
 
@@ -49,6 +76,26 @@ protected:
     // Evaluates a Gaussian kernel with bandwidth SIGMA for all relative shifts between input images X and Y, which must both be MxN. They must    also be periodic (ie., pre-processed with a cosine window).
     cv::Mat gaussianCorrelation(cv::Mat x1, cv::Mat x2);
 
+    // Linear kernel for all relative shifts between X and Y, which skips the exponential.
+    cv::Mat linearCorrelation(cv::Mat x1, cv::Mat x2);
+
+    // Channel-summed cross-correlation shared by both kernels. Channel spectra are summed, then inverted once.
+    // Also gives the energies of X and Y, and sets _similarity when they differ.
+    cv::Mat crossCorrelation(cv::Mat x1, cv::Mat x2, double& xx, double& yy);
+
+    // Kernel the tracker was configured with
+    cv::Mat correlation(cv::Mat x1, cv::Mat x2);
+
+    // Spectrum of that kernel. The linear kernel comes straight from the summed cross spectrum,
+    // so detection and training only run the per-channel transforms and one inverse of the response.
+    void kernelSpectrum(cv::Mat x1, cv::Mat x2, cv::Mat& kf);
+
+    // Channel cross spectra of X and Y summed into _spec[2]
+    void crossSpectrum(cv::Mat x1, cv::Mat x2);
+
+    // Energies of X and Y
+    void energies(cv::Mat x1, cv::Mat x2, double& xx, double& yy);
+
     // Create Gaussian Peak. Function called only in the first frame.
     cv::Mat createGaussianPeak(int sizey, int sizex);
 
@@ -56,9 +103,31 @@ protected:
     // Initialize Hanning window. Function called only in the first frame.
     void createHanningMats();
 
+    // Process-wide caches, shared by all trackers. Returned matrices are read-only.
+    static cv::Mat sharedHanning(int rows, int cols);
+    static cv::Mat sharedGaussianPeak(int rows, int cols, float output_sigma);
+
     // Calculate sub-pixel peak for one dimension
     float subPixelPeak(float left, float center, float right);
 
+    // 1-D scale filter (DSST): labels, window and model size for the current target. Trains with factor 1.
+    void initScale(const cv::Mat& image);
+
+    // Scale change of the target at the current position, one of the sampled scale factors
+    float detectScale(const cv::Mat& image);
+
+    // train the scale filter at the current position and size
+    void trainScale(const cv::Mat& image, float train_interp_factor);
+
+    // Compact features of the target at every sampled scale, one column per scale
+    cv::Mat getScaleSample(const cv::Mat& image);
+
+    // Channel i of x as a patch, dequantized from _qtmpl into buf when x is the packed template (empty)
+    cv::Mat channel(cv::Mat x, int i, cv::Mat& buf);
+
+    // Model spectrum in float, dequantized when stored packed
+    cv::Mat model();
+
     cv::Mat _alphaf;
     cv::Mat _prob;
 
@@ -69,11 +138,33 @@ protected:
     cv::Mat _tmpl;
     cv::Size _tmpl_sz;
 
+    // Scale filter
+    cv::Mat _scale_num;  // features x scales spectra
+    cv::Mat _scale_den;  // 1 x scales, real in a complex spectrum
+    cv::Mat _scale_prob; // label spectrum
+    std::vector<float> _scale_factors;
+    std::vector<float> _scale_hann;
+    cv::Size _scale_model_sz;
+    float _scale_min;
+    float _scale_max;
+
+    // _tmpl and _alphaf at reduced precision, these are empty then
+    quantizedMat _qtmpl;
+    quantizedMat _qalphaf;
+
 private:
+    bool _cfg[5]; // constructor flags: hog, fixed_window, multiscale, lab, linear
     int size_patch[3];
-    cv::Mat hann;
+    cv::Mat hann; // rows x cols window, shared; applied to each HOG feature row
     float _scale;
     int _gaussian_size;
     bool _hogfeatures;
     bool _labfeatures;
+    bool _linear;
+    KCFKernels::kernelGeometry _geom; // size_patch of the current template
+    const KCFKernels::kernelOps* _kernels; // element-wise kernels selected for _geom
+    cv::Mat _spec[3]; // FFT buffers reused across correlations
+    KCFKernels::responseStats _response; // statistics of the last detection
+    float _similarity; // normalized correlation of the last detected features with the template, at the best shift
+    int _skipped; // trainings deferred since the last one
 };
@@ -0,0 +1,191 @@
+#include "kissfft.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+
+kissPlan::kissPlan(int rows, int cols, bool backwards)
+    : _rows(rows), _cols(cols), _backwards(backwards)
+{
+    build(_row_plan, cols);
+    build(_col_plan, rows);
+
+    _line.resize(std::max(rows, cols));
+
+    int max_radix = 1;
+    for (size_t i = 0; i < _row_plan.factors.size(); i += 2)
+        max_radix = std::max(max_radix, _row_plan.factors[i]);
+    for (size_t i = 0; i < _col_plan.factors.size(); i += 2)
+        max_radix = std::max(max_radix, _col_plan.factors[i]);
+    _radix.resize(max_radix);
+}
+
+// Factor n into 4s first, then 2s, then odd radices, and tabulate the twiddles
+void kissPlan::build(plan1d& p, int n)
+{
+    p.n = n;
+    p.factors.clear();
+    p.twiddles.resize(n);
+
+    const double phase = (_backwards ? 2 : -2) * 3.14159265358979323846 / n;
+    for (int i = 0; i < n; i++)
+        p.twiddles[i] = cpx((float) std::cos(phase * i), (float) std::sin(phase * i));
+
+    int radix = 4;
+    int floor_sqrt = (int) std::floor(std::sqrt((double) n));
+    do {
+        while (n % radix) {
+            switch (radix) {
+                case 4: radix = 2; break;
+                case 2: radix = 3; break;
+                default: radix += 2; break;
+            }
+            if (radix > floor_sqrt)
+                radix = n;
+        }
+        n /= radix;
+        p.factors.push_back(radix);
+        p.factors.push_back(n);
+    } while (n > 1);
+}
+
+void kissPlan::execute(cv::Mat src, cv::Mat& dst)
+{
+    assert(src.rows == _rows && src.cols == _cols);
+    assert(src.depth() == CV_32F);
+
+    dst.create(_rows, _cols, CV_32FC2);
+
+    // Rows, through the line buffer so that dst may be src
+    for (int i = 0; i < _rows; i++) {
+        if (src.channels() == 1) {
+            const float* in = src.ptr<float>(i);
+            for (int j = 0; j < _cols; j++)
+                _line[j] = cpx(in[j], 0);
+        }
+        else {
+            const cpx* in = (const cpx*) src.ptr<float>(i);
+            std::copy(in, in + _cols, _line.begin());
+        }
+        transform(_row_plan, (cpx*) dst.ptr<float>(i), &_line[0], 1);
+    }
+
+    // Columns, gathered with a stride and scattered back
+    const float scale = _backwards ? 1.f / (_rows * _cols) : 1.f;
+    const int stride = (int) (dst.step1() / 2);
+    cpx* data = (cpx*) dst.ptr<float>(0);
+
+    for (int j = 0; j < _cols; j++) {
+        transform(_col_plan, &_line[0], data + j, stride);
+        for (int i = 0; i < _rows; i++)
+            data[i * stride + j] = _line[i] * scale;
+    }
+}
+
+void kissPlan::transform(const plan1d& p, cpx* out, const cpx* in, int in_stride)
+{
+    work(p, out, in, 1, in_stride, &p.factors[0]);
+}
+
+// Decimation in time: transform the radix interleaved subsequences recursively, then combine
+void kissPlan::work(const plan1d& p, cpx* out, const cpx* in, int fstride, int in_stride, const int* factors)
+{
+    const int radix = factors[0];
+    const int m = factors[1];
+    cpx* const begin = out;
+    const cpx* const end = out + radix * m;
+
+    if (m == 1) {
+        do {
+            *out = *in;
+            in += fstride * in_stride;
+        } while (++out != end);
+    }
+    else {
+        do {
+            work(p, out, in, fstride * radix, in_stride, factors + 2);
+            in += fstride * in_stride;
+        } while ((out += m) != end);
+    }
+
+    out = begin;
+    switch (radix) {
+        case 2: bfly2(p, out, fstride, m); break;
+        case 3: bfly3(p, out, fstride, m); break;
+        case 4: bfly4(p, out, fstride, m); break;
+        default: bflyGeneric(p, out, fstride, m, radix); break;
+    }
+}
+
+void kissPlan::bfly2(const plan1d& p, cpx* out, int fstride, int m)
+{
+    cpx* out2 = out + m;
+    for (int k = 0; k < m; k++) {
+        cpx t = out2[k] * p.twiddles[k * fstride];
+        out2[k] = out[k] - t;
+        out[k] += t;
+    }
+}
+
+void kissPlan::bfly3(const plan1d& p, cpx* out, int fstride, int m)
+{
+    const float epi3 = p.twiddles[fstride * m].imag();
+
+    for (int k = 0; k < m; k++) {
+        cpx s1 = out[k + m] * p.twiddles[k * fstride];
+        cpx s2 = out[k + 2 * m] * p.twiddles[2 * k * fstride];
+        cpx s3 = s1 + s2;
+        cpx s0 = (s1 - s2) * epi3;
+
+        cpx half = out[k] - s3 * 0.5f;
+        out[k] += s3;
+        out[k + 2 * m] = cpx(half.real() + s0.imag(), half.imag() - s0.real());
+        out[k + m] = cpx(half.real() - s0.imag(), half.imag() + s0.real());
+    }
+}
+
+void kissPlan::bfly4(const plan1d& p, cpx* out, int fstride, int m)
+{
+    for (int k = 0; k < m; k++) {
+        cpx s0 = out[k + m] * p.twiddles[k * fstride];
+        cpx s1 = out[k + 2 * m] * p.twiddles[2 * k * fstride];
+        cpx s2 = out[k + 3 * m] * p.twiddles[3 * k * fstride];
+
+        cpx s5 = out[k] - s1;
+        out[k] += s1;
+        cpx s3 = s0 + s2;
+        cpx s4 = s0 - s2;
+        out[k + 2 * m] = out[k] - s3;
+        out[k] += s3;
+
+        if (_backwards) {
+            out[k + m] = cpx(s5.real() - s4.imag(), s5.imag() + s4.real());
+            out[k + 3 * m] = cpx(s5.real() + s4.imag(), s5.imag() - s4.real());
+        }
+        else {
+            out[k + m] = cpx(s5.real() + s4.imag(), s5.imag() - s4.real());
+            out[k + 3 * m] = cpx(s5.real() - s4.imag(), s5.imag() + s4.real());
+        }
+    }
+}
+
+void kissPlan::bflyGeneric(const plan1d& p, cpx* out, int fstride, int m, int radix)
+{
+    cpx* scratch = &_radix[0];
+
+    for (int u = 0; u < m; u++) {
+        for (int q1 = 0, k = u; q1 < radix; q1++, k += m)
+            scratch[q1] = out[k];
+
+        for (int q1 = 0, k = u; q1 < radix; q1++, k += m) {
+            int twidx = 0;
+            out[k] = scratch[0];
+            for (int q = 1; q < radix; q++) {
+                twidx += fstride * k;
+                if (twidx >= p.n)
+                    twidx -= p.n;
+                out[k] += scratch[q] * p.twiddles[twidx];
+            }
+        }
+    }
+}
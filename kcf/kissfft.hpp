@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef _KISSFFT_HPP_
+#define _KISSFFT_HPP_
+#endif
+
+#include "ffttools.hpp"
+
+#include <complex>
+#include <vector>
+
+// Mixed-radix FFT in the manner of KissFFT: radix 4, 2 and 3 butterflies plus a generic one,
+// with factors and twiddles computed once per size. The 2-D transform runs rows, then columns.
+class kissPlan : public FFTTools::fftPlan
+{
+public:
+    kissPlan(int rows, int cols, bool backwards);
+
+    void execute(cv::Mat src, cv::Mat& dst);
+
+private:
+    typedef std::complex<float> cpx;
+
+    struct plan1d {
+        int n;
+        std::vector<int> factors; // (radix, remaining length) pairs
+        std::vector<cpx> twiddles;
+    };
+
+    void build(plan1d& p, int n);
+    void transform(const plan1d& p, cpx* out, const cpx* in, int in_stride);
+    void work(const plan1d& p, cpx* out, const cpx* in, int fstride, int in_stride, const int* factors);
+
+    void bfly2(const plan1d& p, cpx* out, int fstride, int m);
+    void bfly3(const plan1d& p, cpx* out, int fstride, int m);
+    void bfly4(const plan1d& p, cpx* out, int fstride, int m);
+    void bflyGeneric(const plan1d& p, cpx* out, int fstride, int m, int radix);
+
+    int _rows;
+    int _cols;
+    bool _backwards;
+
+    plan1d _row_plan;
+    plan1d _col_plan;
+
+    std::vector<cpx> _line;    // one row or column
+    std::vector<cpx> _radix;   // generic butterfly scratch
+};
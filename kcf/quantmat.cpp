@@ -0,0 +1,100 @@
+#include "quantmat.hpp"
+
+
+quantizedMat::quantizedMat()
+    : _rows(0), _cols(0), _type(CV_32F), _energy(0)
+{
+}
+
+void quantizedMat::store(const cv::Mat& m, int precision, int groups)
+{
+    assert(m.isContinuous() && m.depth() == CV_32F);
+    assert(precision == QMAT_FLOAT16 || precision == QMAT_INT8);
+
+    _rows = m.rows;
+    _cols = m.cols;
+    _type = m.type();
+
+    cv::Mat flat = m.reshape(1, groups);
+
+    if (precision == QMAT_FLOAT16) {
+        flat.convertTo(_data, CV_16F);
+        _scales.assign(groups, 1.0f);
+    }
+    else {
+        // Symmetric range, the largest magnitude of each group maps to 127
+        _data.create(flat.rows, flat.cols, CV_8S);
+        _scales.resize(groups);
+        for (int i = 0; i < groups; i++) {
+            double max_abs = cv::norm(flat.row(i), cv::NORM_INF);
+            _scales[i] = max_abs > 0 ? (float) (max_abs / 127) : 1.0f;
+
+            cv::Mat q = _data.row(i);
+            flat.row(i).convertTo(q, CV_8S, 1.0 / _scales[i]);
+        }
+    }
+
+    // Energy of what the correlation will see, not of the input. The rounding error lies within
+    // half a step, so its own int8 scale resolves it to a small fraction of a step.
+    cv::Mat row, err;
+    _residual.create(flat.rows, flat.cols, CV_8S);
+    _residual_scales.resize(groups);
+    _energy = 0;
+    for (int i = 0; i < groups; i++) {
+        loadRow(i, row);
+        _energy += row.dot(row);
+
+        cv::subtract(flat.row(i), row, err);
+        double max_err = cv::norm(err, cv::NORM_INF);
+        _residual_scales[i] = max_err > 0 ? (float) (max_err / 127) : 1.0f;
+
+        cv::Mat r = _residual.row(i);
+        err.convertTo(r, CV_8S, 1.0 / _residual_scales[i]);
+    }
+}
+
+void quantizedMat::load(cv::Mat& dst) const
+{
+    dst.create(_rows, _cols, _type);
+
+    cv::Mat flat = dst.reshape(1, _data.rows);
+    for (int i = 0; i < _data.rows; i++) {
+        cv::Mat row = flat.row(i);
+        loadRow(i, row);
+    }
+}
+
+void quantizedMat::loadForUpdate(cv::Mat& dst) const
+{
+    load(dst);
+
+    cv::Mat flat = dst.reshape(1, _data.rows), err;
+    for (int i = 0; i < _data.rows; i++) {
+        _residual.row(i).convertTo(err, CV_32F, _residual_scales[i]);
+        cv::Mat row = flat.row(i);
+        row += err;
+    }
+}
+
+void quantizedMat::loadRow(int group, cv::Mat& dst) const
+{
+    _data.row(group).convertTo(dst, CV_32F, _scales[group]);
+}
+
+double quantizedMat::energy() const
+{
+    return _energy;
+}
+
+bool quantizedMat::empty() const
+{
+    return _data.empty();
+}
+
+void quantizedMat::release()
+{
+    _data.release();
+    _scales.clear();
+    _residual.release();
+    _residual_scales.clear();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef _QUANTMAT_HPP_
+#define _QUANTMAT_HPP_
+#endif
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+// Storage precision of KCF models
+#define QMAT_FLOAT32 0
+#define QMAT_FLOAT16 1
+#define QMAT_INT8 2
+
+// A float matrix stored at reduced precision. It is split into groups of consecutive elements,
+// one feature channel or one spectrum row each, and int8 values carry one scale per group.
+// The rounding error of each store is kept as int8 with its own scale per group, so a matrix
+// updated in small steps, like a blended model, still follows the float32 one.
+class quantizedMat
+{
+public:
+    quantizedMat();
+
+    // Quantize a continuous CV_32F or CV_32FC2 matrix into `groups` equal groups
+    void store(const cv::Mat& m, int precision, int groups);
+
+    // Dequantize the whole matrix, with its original shape and type
+    void load(cv::Mat& dst) const;
+
+    // Dequantize with the rounding error of the last store added back. Updates are applied to this,
+    // since with load() a change smaller than half a step would round back to the stored value.
+    void loadForUpdate(cv::Mat& dst) const;
+
+    // Dequantize one group into a 1 x (elements per group) CV_32F matrix
+    void loadRow(int group, cv::Mat& dst) const;
+
+    // Sum of squares of the dequantized values
+    double energy() const;
+
+    bool empty() const;
+
+    void release();
+
+private:
+    cv::Mat _data; // groups x elements per group, CV_16F or CV_8S
+    std::vector<float> _scales;
+    cv::Mat _residual; // rounding error of the last store, groups x elements per group, CV_8S
+    std::vector<float> _residual_scales;
+    int _rows;
+    int _cols;
+    int _type;
+    double _energy;
+};
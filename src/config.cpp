@@ -0,0 +1,170 @@
+/**
+ * @file config.cpp
+ * @brief Runtime settings of the MOT system.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "config.hpp"
+
+#include <sstream>
+
+
+/* Every setting by name, with how to write and read it. */
+struct configOption{
+
+    const char* key;
+    void (*set)(motConfig& cfg, double value);
+    double (*get)(const motConfig& cfg);
+};
+
+#define CONFIG_OPTION(key, member, type) \
+    { key, [](motConfig& cfg, double value){ cfg.member = (type)value; }, \
+           [](const motConfig& cfg){ return (double)cfg.member; } }
+
+static const configOption options[] = {
+
+    CONFIG_OPTION("detect_interval", detect.period, int),
+    CONFIG_OPTION("fd_threshold", detect.fd_threshold, int),
+    CONFIG_OPTION("bg_low_threshold", detect.low_threshold, int),
+    CONFIG_OPTION("bg_high_threshold", detect.high_threshold, int),
+    CONFIG_OPTION("min_bbox_height", detect.min_bbox_height, int),
+    CONFIG_OPTION("min_bbox_width", detect.min_bbox_width, int),
+    CONFIG_OPTION("detect_adaptive", detect.adaptive, bool),
+    CONFIG_OPTION("detect_min_interval", detect.min_period, int),
+    CONFIG_OPTION("detect_max_interval", detect.max_period, int),
+    CONFIG_OPTION("activity_low", detect.activity_low, float),
+    CONFIG_OPTION("activity_high", detect.activity_high, float),
+    CONFIG_OPTION("frame_budget_ms", detect.frame_budget_ms, float),
+
+    CONFIG_OPTION("max_tcr", track.max_tcr, int),
+    CONFIG_OPTION("budget_ms", track.budget_ms, float),
+    CONFIG_OPTION("max_defer", track.max_defer, int),
+    CONFIG_OPTION("max_cost", track.max_cost, float),
+
+    CONFIG_OPTION("kcf_template_size", track.kcf_template_size, int),
+    CONFIG_OPTION("kcf_cell_size", track.kcf_cell_size, int),
+    CONFIG_OPTION("kcf_padding", track.kcf_padding, float),
+    CONFIG_OPTION("kcf_interp_factor", track.kcf_interp_factor, float),
+    CONFIG_OPTION("kcf_train_similarity", track.kcf_train_similarity, float),
+    CONFIG_OPTION("kcf_train_max_skip", track.kcf_train_max_skip, int),
+    CONFIG_OPTION("kcf_model_precision", track.kcf_model_precision, int),
+};
+
+#undef CONFIG_OPTION
+
+
+/**
+ * @brief Set one setting.
+ *
+ * @param key       Name of the setting, one of `keys()`.
+ * @param value     New value. It's truncated for integer settings.
+ *
+ * @return Boolean value. Return `false` if there is no such setting.
+ *
+ */
+bool motConfig::set(const string& key, double value){
+
+    for(const configOption& opt: options){
+
+        if(key == opt.key){
+
+            opt.set(*this, value);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Set one setting from a `key=value` string.
+ *
+ * @return Boolean value. Return `false` if the string is malformed or there is no such setting.
+ *
+ */
+bool motConfig::set(const string& key_value){
+
+    size_t eq = key_value.find('=');
+
+    if(eq == string::npos){
+        return false;
+    }
+
+    try{
+
+        size_t used = 0;
+        string value = key_value.substr(eq + 1);
+        double number = std::stod(value, &used);
+
+        return used == value.size() && set(key_value.substr(0, eq), number);
+    }
+    catch(const std::exception&){
+
+        return false;
+    }
+}
+
+/**
+ * @brief Check every setting, so bad values are reported before anything runs instead of 
+ *        being thrown from the constructors of Detection and Tracking.
+ *
+ * @param error     What is wrong, if anything. This is the result of this function.
+ *
+ * @return Boolean value. Return `false` if a setting is out of range.
+ *
+ */
+bool motConfig::validate(string& error) const{
+
+    try{
+
+        detect.validate();
+        track.validate();
+    }
+    catch(const std::runtime_error& e){
+
+        error = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the settings that differ from the defaults, as `key=value` separated by spaces.
+ *
+ */
+string motConfig::str(void) const{
+
+    const motConfig defaults;
+    std::ostringstream out;
+
+    for(const configOption& opt: options){
+
+        if(opt.get(*this) != opt.get(defaults)){
+
+            if(out.tellp() > 0){
+                out << " ";
+            }
+            out << opt.key << "=" << opt.get(*this);
+        }
+    }
+
+    return out.tellp() > 0 ? out.str() : string("defaults");
+}
+
+/**
+ * @brief Get the names of all the settings.
+ *
+ */
+vector<string> motConfig::keys(void){
+
+    vector<string> res;
+
+    for(const configOption& opt: options){
+        res.push_back(opt.key);
+    }
+
+    return res;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+#include "funcs.hpp"
+#include "detect.hpp"
+#include "track.hpp"
+
+
+/**
+ * @struct motConfig
+ * @brief Runtime settings of the whole MOT system, set by name, e.g. `detect_interval=3`.
+ *
+ * Defaults are the macros of `detect.hpp` and `track.hpp`, so an untouched configuration 
+ * behaves as a build without it.
+ *
+ */
+struct motConfig{
+
+    detectConfig detect;
+    trackConfig track;
+
+    bool set(const string& key, double value);
+    bool set(const string& key_value);
+
+    string str(void) const;
+
+    bool validate(string& error) const;
+
+    static vector<string> keys(void);
+};
+
+
+#endif
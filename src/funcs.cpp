@@ -11,78 +11,260 @@
 #include "funcs.hpp"
 #include "detect.hpp"
 #include "track.hpp"
+#include "pipeline.hpp"
+#include "source.hpp"
+#include "render.hpp"
+#include "workerpool.hpp"
+#include "tracksink.hpp"
+#include "config.hpp"
+#include "replaylog.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX__) || defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 /**
  * @brief Top-level abstract function that describes the overall system logic.
  *
+ * Capture, detection and tracking run as a pipeline of threads, connected by 
+ * single-producer/single-consumer queues of `PIPE_SLOTS` recycled frame slots. Detection of 
+ * frame t+1 overlaps tracking of frame t. Every frame still goes through detection and then
+ * tracking in order, so results are the same as a single-threaded loop. The exception is the 
+ * adaptive detection interval: its feedback from tracking arrives a few frames late and 
+ * depends on measured time.
+ * Tracking only reads the frame. Results are drawn on a copy by the render stage, which runs 
+ * on the calling thread as HighGUI requires, or is skipped in headless runs.
+ *
  * @param input     Input for the MOT system. It could be a path to iamge sequence, video 
- *                  or a camera index. 
+ *                  or a camera index. Image sequences are decoded ahead by `sequenceSource`.
  *                  Default input is the test set `PETS09-S2L1`, which is an image sequence.
+ * @param cfg       Runtime settings of Detection and Tracking.
+ * @param render    Whether to draw and display the results. Default value is `RENDER_RESULTS`.
+ * @param output    File the tracks are written to, by a `trackSink`. Default value is 
+ *                  `TRACK_OUTPUT`. Nothing is written if it's empty.
+ * @param record    Replay log the detections and tracks of every frame are recorded to, 
+ *                  see `replaylog.hpp`. Default value is `RECORD_OUTPUT`. Nothing is recorded 
+ *                  if it's empty.
  * 
  * @return Boolean value. Return `true` if the MOT system goes on properly.
  * 
  */
-bool func::MOT(string input){
+bool func::MOT(string input, const motConfig& cfg, bool render, string output, string record){
 
-    cv::VideoCapture cap;
+    frameSource* source = frameSource::open(input);
 
-    /* Input is a camera. */
-    if (std::isdigit(input[0])) {
+    if (source == nullptr) {
 
-        int cam_index = std::stoi(input);
-        cap.open(cam_index); 
+        std::cerr << "ERRO: Failed to Open Input: " << input << std::endl;
+        return false;
+    }
 
-    } 
-    /* Input is video or image sequence. */
-    else {
+    Mat frame;
 
-        cap.open(input);
+    if(source -> read(frame) == false){
+        delete source;
+        throw std::runtime_error("Failed to read first frame.");
     }
 
-    if (!cap.isOpened()) {
+    objDetect* detect = new objDetect(frame, cfg.detect);
+    objTrack* track = new objTrack(cfg.track);
 
-        std::cerr << "ERRO: Failed to Open Input: " << input << std::endl;
-        return false;
+    trackSink* sink = nullptr;
+
+    if(false == output.empty()){
+
+        sink = new trackSink(output);
+
+        if(false == sink -> isOpened()){
+            std::cerr << "ERRO: Failed to Open Output: " << output << std::endl;
+        }
     }
 
-    Mat frame;
+    replayWriter* recorder = nullptr;
 
-    if(cap.read(frame) == false){
-        throw std::runtime_error("Failed to read first frame.");
+    if(false == record.empty()){
+
+        recorder = new replayWriter();
+
+        if(false == recorder -> open(record)){
+            std::cerr << "ERRO: Failed to Open Record: " << record << std::endl;
+        }
     }
 
-    objDetect* detect = new objDetect(frame,DETEC_INTV);
-    objTrack* track = new objTrack(MAX_TCR);
+    /* Slots go round: free -> capture -> detection -> tracking -> render -> free. */
+    frameSlot slots[PIPE_SLOTS];
+    spscQueue<frameSlot*> free_slots(PIPE_SLOTS), to_detect(PIPE_SLOTS), to_track(PIPE_SLOTS);
+    spscQueue<frameSlot*> to_render(PIPE_SLOTS);
 
-    vector<fdObject> fd_objs;
-    while(cap.read(frame)){
+    for(frameSlot& slot: slots){
+        free_slots.push(&slot);
+    }
 
-        if(detect -> tick(frame)){
-            fd_objs = detect -> getObjects();
+    std::atomic<bool> stop(false);
+    stageStats capture_stats, detect_stats, track_stats, render_stats, latency;
 
-            track -> tick(frame, fd_objs);        
+    std::thread capture_thread([&](){
 
-            /* Only for testing object detection. */
-            for(fdObject& fd_obj: fd_objs){
-                /* Blue(FD). */
-                cv::rectangle(frame,fd_obj.resultRect(),cv::Scalar(255,0,0));
+        /* The first frame was read already. */
+        int index = 1;
+
+        while(false == stop.load(std::memory_order_relaxed)){
+
+            frameSlot* slot = free_slots.pop();
+            pipeClock::time_point t_read = pipeClock::now();
+
+            if(false == source -> read(slot -> frame)){
+
+                slot -> last = true;
+                to_detect.push(slot);
+                return;
             }
+
+            slot -> t_read = t_read;
+            slot -> index = ++ index;
+            capture_stats.add(t_read);
+            to_detect.push(slot);
         }
-        else{
-            track -> tick(frame);
+
+        /* Stopped by the user. */
+        frameSlot* slot = free_slots.pop();
+        slot -> last = true;
+        to_detect.push(slot);
+    });
+
+    std::thread detect_thread([&](){
+
+        for(;;){
+
+            frameSlot* slot = to_detect.pop();
+
+            if(slot -> last){
+
+                to_track.push(slot);
+                return;
+            }
+
+            pipeClock::time_point t_start = pipeClock::now();
+
+            slot -> detected = detect -> tick(slot -> frame);
+            if(slot -> detected){
+                slot -> fd_objs = detect -> getObjects();
+            }
+
+            slot -> detect_ms = std::chrono::duration<float, std::milli>(pipeClock::now() - t_start).count();
+            detect_stats.add(t_start);
+            to_track.push(slot);
         }
+    });
 
-        cv::imshow(string("Test Set: ") + NAME,frame);        
+    std::thread track_thread([&](){
 
-        /* Press `ESC` to quit. */
-        if (cv::waitKey(1000 / frameRate) == 27){
+        for(;;){
+
+            frameSlot* slot = to_track.pop();
+
+            if(slot -> last){
+
+                to_render.push(slot);
+                return;
+            }
+
+            pipeClock::time_point t_start = pipeClock::now();
+
+            if(slot -> detected){
+                track -> tick(slot -> frame, slot -> fd_objs);        
+            }
+            else{
+                track -> tick(slot -> frame);
+            }
+            track -> getResults(slot -> tcr_results);
+
+            /* Stages overlap, a frame takes as long as the slower of the two. */
+            float track_ms = std::chrono::duration<float, std::milli>(pipeClock::now() - t_start).count();
+            detect -> setFeedback(track -> getWeakCount(), std::max(slot -> detect_ms, track_ms));
+
+            track_stats.add(t_start);
+            to_render.push(slot);
+        }
+    });
+
+    pipeClock::time_point t_begin = pipeClock::now();
+
+    /* Drawn on, so the frames of the slots stay untouched. */
+    Mat canvas;
+
+    for(;;){
+
+        frameSlot* slot = to_render.pop();
+
+        if(slot -> last){
             break;
         }
 
+        if(render){
+
+            pipeClock::time_point t_start = pipeClock::now();
+
+            func::render(slot -> frame, slot -> detected ? &slot -> fd_objs : nullptr, 
+                         slot -> tcr_results, canvas);
+            cv::imshow(string("Test Set: ") + NAME, canvas);
+
+            render_stats.add(t_start);
+        }
+
+        if(sink != nullptr){
+            sink -> publish(slot -> index, slot -> tcr_results);
+        }
+
+        if(recorder != nullptr){
+            recorder -> write(slot -> index, slot -> detected ? &slot -> fd_objs : nullptr, &slot -> tcr_results);
+        }
+
+        latency.add(slot -> t_read);
+        free_slots.push(slot);
+
+        /* Press `ESC` to quit. */
+        if (render && cv::waitKey(1000 / frameRate) == 27){
+            stop.store(true, std::memory_order_relaxed);
+        }
     }
 
+    double wall_s = std::chrono::duration<double>(pipeClock::now() - t_begin).count();
+
+    capture_thread.join();
+    detect_thread.join();
+    track_thread.join();
+
+    capture_stats.report("Capture");
+    detect_stats.report("Detection");
+    track_stats.report("Tracking");
+    render_stats.report("Rendering");
+    latency.report("End-to-end");
+    cout << "Throughput: " << (wall_s > 0.0 ? track_stats.frames / wall_s : 0.0) << " fps" << endl;
+
     delete detect;
     delete track;
+    delete source;
+
+    if(sink != nullptr){
+
+        if(sink -> dropped() > 0){
+            cout << "Track records dropped: " << sink -> dropped() << endl;
+        }
+        delete sink;
+    }
+
+    if(recorder != nullptr){
+
+        if(false == recorder -> close()){
+            std::cerr << "ERRO: Failed to Write Record: " << record << std::endl;
+        }
+        delete recorder;
+    }
 
     return true;
 
@@ -90,6 +272,125 @@ bool func::MOT(string input){
 
 
 
+/**
+ * @brief Run the MOT system on several inputs in one process, without display.
+ *
+ * Every stream keeps its own Detection and Tracking. Frames are processed in rounds, one frame
+ * of every stream still running per round. Streams of a round, and tracker updates within 
+ * each stream, all run on one shared `workerPool`. OpenCV's own threads are disabled,
+ * so the pool is the only one competing for cores.
+ *
+ * @param inputs    Inputs of the streams, each of them as `input` of `MOT`.
+ * @param cfg       Runtime settings of Detection and Tracking, the same for all streams.
+ * 
+ * @return Boolean value. Return `true` if the MOT system goes on properly.
+ * 
+ */
+bool func::multiMOT(const vector<string>& inputs, const motConfig& cfg){
+
+    struct streamContext{
+
+        frameSource* source = nullptr;
+        objDetect* detect = nullptr;
+        objTrack* track = nullptr;
+
+        Mat frame;
+        bool running = false;
+
+        /* Read, detection and tracking of each frame. */
+        stageStats latency;
+        pipeClock::time_point t_begin;
+        pipeClock::time_point t_end;
+    };
+
+    cv::setNumThreads(0);
+
+    workerPool pool;
+    parallelForFn parallel_for = [&pool](int n, const std::function<void(int)>& body){
+        pool.parallelFor(n, body);
+    };
+
+    const int n = inputs.size();
+    vector<streamContext> streams(n);
+    bool all_opened = true;
+
+    for(int i = 0; i < n; ++ i){
+
+        streamContext& st = streams[i];
+        st.source = frameSource::open(inputs[i]);
+
+        if(st.source == nullptr || false == st.source -> read(st.frame)){
+
+            std::cerr << "ERRO: Failed to Open Input: " << inputs[i] << std::endl;
+            all_opened = false;
+            break;
+        }
+
+        st.detect = new objDetect(st.frame, cfg.detect);
+        st.track = new objTrack(cfg.track);
+        st.track -> setParallelFor(parallel_for);
+
+        st.running = true;
+        st.t_begin = pipeClock::now();
+    }
+
+    vector<int> active;
+    for(int i = 0; all_opened && i < n; ++ i){
+        active.push_back(i);
+    }
+
+    while(false == active.empty()){
+
+        pool.parallelFor(active.size(), [&](int k){
+
+            streamContext& st = streams[active[k]];
+            pipeClock::time_point t_read = pipeClock::now();
+
+            if(false == st.source -> read(st.frame)){
+
+                st.running = false;
+                st.t_end = t_read;
+                return;
+            }
+
+            if(st.detect -> tick(st.frame)){
+                st.track -> tick(st.frame, st.detect -> getObjects());
+            }
+            else{
+                st.track -> tick(st.frame);
+            }
+
+            st.detect -> setFeedback(st.track -> getWeakCount(), 
+                std::chrono::duration<float, std::milli>(pipeClock::now() - t_read).count());
+            st.latency.add(t_read);
+        });
+
+        active.erase(std::remove_if(active.begin(), active.end(), 
+                        [&](int i){ return false == streams[i].running; }), active.end());
+    }
+
+    for(int i = 0; all_opened && i < n; ++ i){
+
+        const streamContext& st = streams[i];
+        double wall_s = std::chrono::duration<double>(st.t_end - st.t_begin).count();
+
+        cout << "Stream " << i << " (" << inputs[i] << "): " 
+            << (wall_s > 0.0 ? st.latency.frames / wall_s : 0.0) << " fps" << endl;
+        st.latency.report("    Latency");
+    }
+
+    for(streamContext& st: streams){
+
+        delete st.detect;
+        delete st.track;
+        delete st.source;
+    }
+
+    return all_opened;
+}
+
+
+
 /**
  * @brief Calculate Intersection over Union (IoU) of two bounding boxes. 
  *
@@ -114,9 +415,151 @@ float func::IoU(const Rect& bbox_a, const Rect& bbox_b){
     return iou;
 }
 
+/**
+ * @brief Calculate IoU of one box against a row of boxes.
+ *
+ * The first box is broadcast to all SIMD lanes, and boxes of the row are processed 
+ * 8 (AVX), 4 (SSE or NEON on AArch64) at a time. The rest are done one by one. 
+ * 
+ * Results are the same as `IoU` for boxes with integer coordinates.
+ *
+ * @param ax, ay, aw, ah    The single box.
+ * @param boxes             Row of boxes.
+ * @param iou               IoU values, one per box in `boxes`. This is the result of this function.
+ * 
+ */
+static void IoURow(float ax, float ay, float aw, float ah, const boxArrays& boxes, float* iou){
+
+    const float ax2 = ax + aw, ay2 = ay + ah, a_area = aw * ah;
+    const int n = boxes.n;
+    int i = 0;
+
+#if defined(__AVX__)
+    {
+        const __m256 v_ax = _mm256_set1_ps(ax), v_ay = _mm256_set1_ps(ay);
+        const __m256 v_ax2 = _mm256_set1_ps(ax2), v_ay2 = _mm256_set1_ps(ay2);
+        const __m256 v_area = _mm256_set1_ps(a_area), v_zero = _mm256_setzero_ps();
+
+        for(; i + 8 <= n; i += 8){
+            __m256 bx = _mm256_loadu_ps(boxes.x + i), by = _mm256_loadu_ps(boxes.y + i);
+            __m256 bw = _mm256_loadu_ps(boxes.w + i), bh = _mm256_loadu_ps(boxes.h + i);
+
+            __m256 inter_w = _mm256_sub_ps(_mm256_min_ps(v_ax2, _mm256_add_ps(bx, bw)), _mm256_max_ps(v_ax, bx));
+            __m256 inter_h = _mm256_sub_ps(_mm256_min_ps(v_ay2, _mm256_add_ps(by, bh)), _mm256_max_ps(v_ay, by));
+            __m256 inter = _mm256_mul_ps(_mm256_max_ps(inter_w, v_zero), _mm256_max_ps(inter_h, v_zero));
+            __m256 uni = _mm256_sub_ps(_mm256_add_ps(v_area, _mm256_mul_ps(bw, bh)), inter);
+
+            _mm256_storeu_ps(iou + i, _mm256_div_ps(inter, uni));
+        }
+    }
+#endif
+
+#if defined(__SSE__) || defined(_M_X64)
+    {
+        const __m128 v_ax = _mm_set1_ps(ax), v_ay = _mm_set1_ps(ay);
+        const __m128 v_ax2 = _mm_set1_ps(ax2), v_ay2 = _mm_set1_ps(ay2);
+        const __m128 v_area = _mm_set1_ps(a_area), v_zero = _mm_setzero_ps();
+
+        for(; i + 4 <= n; i += 4){
+            __m128 bx = _mm_loadu_ps(boxes.x + i), by = _mm_loadu_ps(boxes.y + i);
+            __m128 bw = _mm_loadu_ps(boxes.w + i), bh = _mm_loadu_ps(boxes.h + i);
+
+            __m128 inter_w = _mm_sub_ps(_mm_min_ps(v_ax2, _mm_add_ps(bx, bw)), _mm_max_ps(v_ax, bx));
+            __m128 inter_h = _mm_sub_ps(_mm_min_ps(v_ay2, _mm_add_ps(by, bh)), _mm_max_ps(v_ay, by));
+            __m128 inter = _mm_mul_ps(_mm_max_ps(inter_w, v_zero), _mm_max_ps(inter_h, v_zero));
+            __m128 uni = _mm_sub_ps(_mm_add_ps(v_area, _mm_mul_ps(bw, bh)), inter);
+
+            _mm_storeu_ps(iou + i, _mm_div_ps(inter, uni));
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    {
+        /* Division needs AArch64. ARMv7 NEON has only a reciprocal estimate. */
+        const float32x4_t v_ax = vdupq_n_f32(ax), v_ay = vdupq_n_f32(ay);
+        const float32x4_t v_ax2 = vdupq_n_f32(ax2), v_ay2 = vdupq_n_f32(ay2);
+        const float32x4_t v_area = vdupq_n_f32(a_area), v_zero = vdupq_n_f32(0.0f);
+
+        for(; i + 4 <= n; i += 4){
+            float32x4_t bx = vld1q_f32(boxes.x + i), by = vld1q_f32(boxes.y + i);
+            float32x4_t bw = vld1q_f32(boxes.w + i), bh = vld1q_f32(boxes.h + i);
+
+            float32x4_t inter_w = vsubq_f32(vminq_f32(v_ax2, vaddq_f32(bx, bw)), vmaxq_f32(v_ax, bx));
+            float32x4_t inter_h = vsubq_f32(vminq_f32(v_ay2, vaddq_f32(by, bh)), vmaxq_f32(v_ay, by));
+            float32x4_t inter = vmulq_f32(vmaxq_f32(inter_w, v_zero), vmaxq_f32(inter_h, v_zero));
+            float32x4_t uni = vsubq_f32(vaddq_f32(v_area, vmulq_f32(bw, bh)), inter);
+
+            vst1q_f32(iou + i, vdivq_f32(inter, uni));
+        }
+    }
+#endif
+
+    for(; i < n; ++ i){
+
+        float inter_w = std::min(ax2, boxes.x[i] + boxes.w[i]) - std::max(ax, boxes.x[i]);
+        float inter_h = std::min(ay2, boxes.y[i] + boxes.h[i]) - std::max(ay, boxes.y[i]);
+        float inter = std::max(inter_w, 0.0f) * std::max(inter_h, 0.0f);
+
+        iou[i] = inter / (a_area + boxes.w[i] * boxes.h[i] - inter);
+    }
+}
+
+/**
+ * @brief Calculate IoU of every pair of boxes from two sets, using SIMD when available.
+ *
+ * @param boxes_a   First set of bounding boxes. One row of `iou` per box.
+ * @param boxes_b   Second set of bounding boxes. One column of `iou` per box.
+ * @param iou       IoU matrix, row-major, `boxes_a.n` rows of `boxes_b.n` values. 
+ *                  This is the result of this function.
+ * @param stride    Distance between two rows of `iou`, in floats.
+ * 
+ * @return Boolean value. Return `true` if the calculation goes on properly.
+ * 
+ */
+bool func::IoUMatrix(const boxArrays& boxes_a, const boxArrays& boxes_b, float* iou, int stride){
+
+    if(stride < boxes_b.n){
+        return false;
+    }
+
+    for(int i = 0; i < boxes_a.n; ++ i){
+
+        IoURow(boxes_a.x[i], boxes_a.y[i], boxes_a.w[i], boxes_a.h[i], boxes_b, iou + (size_t)i * stride);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get all pairs of boxes from two sets whose IoU is at least `min_iou`.
+ *
+ * Cheapest gating for association. Only the pairs passing the gate are kept.
+ * 
+ * @param boxes_a   First set of bounding boxes.
+ * @param boxes_b   Second set of bounding boxes.
+ * @param pairs     Pairs passing the gate, ordered by `a` then `b`. This is the result of this function.
+ * @param min_iou   Minimum IoU requirement. Default value is `MIN_IOU_REQ`.
+ * 
+ * @return Boolean value. Return `true` if the calculation goes on properly.
+ * 
+ */
+bool func::IoUPairs(const boxArrays& boxes_a, const boxArrays& boxes_b, vector<iouPair>& pairs, 
+    float min_iou){
+
+    pairs.clear();
 
+    vector<float> row(boxes_b.n);
 
+    for(int i = 0; i < boxes_a.n; ++ i){
 
+        IoURow(boxes_a.x[i], boxes_a.y[i], boxes_a.w[i], boxes_a.h[i], boxes_b, row.data());
 
+        for(int j = 0; j < boxes_b.n; ++ j){
 
+            if(row[j] >= min_iou){
+                pairs.push_back({i, j, row[j]});
+            }
+        }
+    }
 
+    return true;
+}
@@ -31,17 +31,61 @@ using cv::Mat, cv::Rect, cv::Point, cv::Size;
 /* Minmum IoU requirement. */
 #define MIN_IOU_REQ (0.3)
 
+/* Meaning-less index. */
+#define INVALID_INDEX (-1)
+
 
 #define ERR_ARG_NUM (1)
 
+/* Draw and display the results. Headless runs skip both, and the display delay. */
+#define RENDER_RESULTS (true)
+
+/* File the tracks are written to by `func::MOT`, e.g. "tracks.txt". Empty for none. */
+#define TRACK_OUTPUT ""
+
+/* Replay log `func::MOT` records detections and tracks to, e.g. "pets.mrep". Empty for none. */
+#define RECORD_OUTPUT ""
+
 class fdObject;
 class objDetect;
 class objTrack;
+struct motConfig;
+
+/**
+ * @struct boxArrays
+ * @brief Bounding boxes packed as a structure of arrays. Box `i` is (x[i], y[i], w[i], h[i]).
+ * 
+ */
+struct boxArrays{
+
+    const float* x;
+    const float* y;
+    const float* w;
+    const float* h;
+    int n;
+};
+
+/**
+ * @struct iouPair
+ * @brief A pair of boxes, `a` from the first set and `b` from the second, and their IoU.
+ * 
+ */
+struct iouPair{
+
+    int a;
+    int b;
+    float iou;
+};
 
 namespace func{
 
     float IoU(const Rect& bbox_a, const Rect& bbox_b);
-    bool MOT(string input);
+    bool IoUMatrix(const boxArrays& boxes_a, const boxArrays& boxes_b, float* iou, int stride);
+    bool IoUPairs(const boxArrays& boxes_a, const boxArrays& boxes_b, vector<iouPair>& pairs, 
+        float min_iou = MIN_IOU_REQ);
+    bool MOT(string input, const motConfig& cfg, bool render = RENDER_RESULTS, string output = TRACK_OUTPUT, 
+        string record = RECORD_OUTPUT);
+    bool multiMOT(const vector<string>& inputs, const motConfig& cfg);
 }
 
 
@@ -9,6 +9,7 @@
  */
 
 #include "funcs.hpp"
+#include "config.hpp"
 #include <opencv2/opencv.hpp>
 
 #include <string>
@@ -16,22 +17,46 @@ using std::string;
 
 
 int main(int argc, char* argv[]){
-    
-    if(argc > 2){
-        std::cerr << "ERROR: Only one argument allowed." << endl;
+
+    /* `key=value` arguments are settings, see `motConfig`. The others are inputs. */
+    motConfig cfg;
+    vector<string> inputs;
+
+    for(int i = 1; i < argc; ++ i){
+
+        string arg = argv[i];
+
+        if(arg.find('=') == string::npos){
+            inputs.push_back(arg);
+        }
+        else if(false == cfg.set(arg)){
+            std::cerr << "ERROR: Unknown setting: " << arg << endl;
+            return ERR_ARG_NUM;
+        }
+    }
+
+    string error;
+    if(false == cfg.validate(error)){
+        std::cerr << "ERROR: Invalid settings: " << error << endl;
         return ERR_ARG_NUM;
     }
 
+    /* Several inputs, one stream each. */
+    if(inputs.size() > 1){
+        func::multiMOT(inputs, cfg);
+        return 0;
+    }
+
     string path;
-    if(2 == argc){
-        path = argv[1];
+    if(1 == inputs.size()){
+        path = inputs[0];
     }
     /* Default test set. */
-    else if(1 == argc){
+    else{
         path = string("../") + NAME + "/" +  imDir + "/%06d" + imExt;
     }
     cout<< path<<endl;
-    func::MOT(path);
+    func::MOT(path, cfg);
 
     return 0;
 }
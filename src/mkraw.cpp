@@ -0,0 +1,64 @@
+/**
+ * @file mkraw.cpp
+ * @brief Converts any input of the MOT system into a raw frame container.
+ * @author wantSomeChips
+ * @date 2025
+ * 
+ */
+
+#include "funcs.hpp"
+#include "source.hpp"
+#include "rawframes.hpp"
+
+#include <string>
+using std::string;
+
+
+int main(int argc, char* argv[]){
+
+    if(argc < 3 || argc > 4 || (argc == 4 && string(argv[3]) != "--gray")){
+        std::cerr << "Usage: mkraw <input> <output" << RAW_EXT << "> [--gray]" << endl;
+        return ERR_ARG_NUM;
+    }
+
+    frameSource* source = frameSource::open(argv[1]);
+
+    if(source == nullptr){
+
+        std::cerr << "ERRO: Failed to Open Input: " << argv[1] << endl;
+        return 1;
+    }
+
+    rawWriter writer;
+    Mat frame;
+    bool ok = true;
+
+    while(ok && source -> read(frame)){
+
+        if(writer.frames() == 0 && false == writer.open(argv[2], frame.size(), argc == 4)){
+
+            std::cerr << "ERRO: Failed to Create: " << argv[2] << endl;
+            ok = false;
+            break;
+        }
+
+        if(false == writer.write(frame)){
+
+            std::cerr << "ERRO: Failed to Write Frame " << writer.frames() << endl;
+            ok = false;
+        }
+    }
+
+    int frames = writer.frames();
+    ok = writer.close() && ok;
+
+    delete source;
+
+    if(false == ok){
+        return 1;
+    }
+
+    cout << frames << " frames written to " << argv[2] << endl;
+
+    return 0;
+}
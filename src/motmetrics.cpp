@@ -0,0 +1,348 @@
+/**
+ * @file motmetrics.cpp
+ * @brief MOTA and IDF1 of tracking results, for tuning against ground truth.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "motmetrics.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <limits>
+#include <algorithm>
+
+
+/**
+ * @brief Minimum cost assignment of rows to columns (Hungarian method), `rows <= cols`.
+ *
+ * @param cost      Row-major cost matrix.
+ * @param rows      Number of rows.
+ * @param cols      Number of columns.
+ * @param row_col   Column assigned to every row. This is the result of this function.
+ *
+ */
+static void assign(const vector<double>& cost, int rows, int cols, vector<int>& row_col){
+
+    const double inf = std::numeric_limits<double>::infinity();
+
+    /* Potentials and matching are 1-based, column 0 is a virtual one. */
+    vector<double> u(rows + 1, 0.0), v(cols + 1, 0.0);
+    vector<int> col_row(cols + 1, 0), way(cols + 1, 0);
+
+    for(int i = 1; i <= rows; ++ i){
+
+        col_row[0] = i;
+        int j0 = 0;
+        vector<double> min_v(cols + 1, inf);
+        vector<bool> used(cols + 1, false);
+
+        do{
+            used[j0] = true;
+            int i0 = col_row[j0], j1 = 0;
+            double delta = inf;
+
+            for(int j = 1; j <= cols; ++ j){
+
+                if(used[j]){
+                    continue;
+                }
+
+                double cur = cost[(size_t)(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+                if(cur < min_v[j]){
+                    min_v[j] = cur;
+                    way[j] = j0;
+                }
+                if(min_v[j] < delta){
+                    delta = min_v[j];
+                    j1 = j;
+                }
+            }
+
+            for(int j = 0; j <= cols; ++ j){
+
+                if(used[j]){
+                    u[col_row[j]] += delta;
+                    v[j] -= delta;
+                }
+                else{
+                    min_v[j] -= delta;
+                }
+            }
+
+            j0 = j1;
+
+        } while(col_row[j0] != 0);
+
+        do{
+            int j1 = way[j0];
+            col_row[j0] = col_row[j1];
+            j0 = j1;
+
+        } while(j0 != 0);
+    }
+
+    row_col.assign(rows, INVALID_INDEX);
+    for(int j = 1; j <= cols; ++ j){
+
+        if(col_row[j] != 0){
+            row_col[col_row[j] - 1] = j - 1;
+        }
+    }
+}
+
+/**
+ * @brief Maximum weight matching of a non-negative weight matrix. Zero-weight pairs stay unmatched.
+ *
+ * @param weight    Row-major weight matrix.
+ * @param rows      Number of rows.
+ * @param cols      Number of columns.
+ * @param row_col   Column matched to every row, `INVALID_INDEX` if none. This is the result of this function.
+ *
+ */
+static void maxMatch(const vector<double>& weight, int rows, int cols, vector<int>& row_col){
+
+    row_col.assign(rows, INVALID_INDEX);
+
+    if(rows == 0 || cols == 0){
+        return;
+    }
+
+    /* The assignment needs no more rows than columns. */
+    bool transposed = rows > cols;
+    int r = transposed ? cols : rows, c = transposed ? rows : cols;
+
+    vector<double> cost((size_t)r * c);
+    for(int i = 0; i < r; ++ i){
+        for(int j = 0; j < c; ++ j){
+            cost[(size_t)i * c + j] = -(transposed ? weight[(size_t)j * cols + i] : weight[(size_t)i * cols + j]);
+        }
+    }
+
+    vector<int> match;
+    assign(cost, r, c, match);
+
+    for(int i = 0; i < r; ++ i){
+
+        int j = match[i];
+        if(j == INVALID_INDEX || cost[(size_t)i * c + j] >= 0.0){
+            continue;
+        }
+
+        if(transposed){
+            row_col[j] = i;
+        }
+        else{
+            row_col[i] = j;
+        }
+    }
+}
+
+static float boxIoU(const motBox& a, const motBox& b){
+
+    float inter_w = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+    float inter_h = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+    float inter = std::max(inter_w, 0.0f) * std::max(inter_h, 0.0f);
+
+    return inter / (a.w * a.h + b.w * b.h - inter);
+}
+
+/**
+ * @brief Load boxes from a MOTChallenge file, `frame,id,x,y,w,h,conf,...` per line.
+ *
+ * Ground truth lines with a zero `conf` column are ignored, as MOTChallenge does.
+ *
+ * @param path      Path to the file.
+ * @param boxes     Boxes in the file. This is the result of this function.
+ *
+ * @return Boolean value. Return `false` if the file can't be read.
+ *
+ */
+bool func::loadMOT(const string& path, vector<motBox>& boxes){
+
+    std::ifstream file(path);
+
+    if(false == file.good()){
+        return false;
+    }
+
+    boxes.clear();
+    string line;
+
+    while(std::getline(file, line)){
+
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+
+        motBox box;
+        float conf = 1.0f;
+
+        if(!(fields >> box.frame >> box.id >> box.x >> box.y >> box.w >> box.h)){
+            continue;
+        }
+        if((fields >> conf) && conf == 0.0f){
+            continue;
+        }
+
+        boxes.push_back(box);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Score a tracking result against ground truth.
+ *
+ * MOTA follows CLEAR MOT: correspondences of the previous frame are kept while their IoU 
+ * allows it, the rest are matched by maximum IoU, and a ground truth track matched to another 
+ * hypothesis than last time counts one identity switch. IDF1 uses the one-to-one mapping of 
+ * whole tracks that maximizes the identity true positives.
+ *
+ * @param gt        Ground truth boxes.
+ * @param hyp       Tracking result.
+ * @param min_iou   IoU of a match. Default value is `EVAL_MIN_IOU`.
+ *
+ * @return Scores of the result.
+ *
+ */
+motScores func::evaluateMOT(const vector<motBox>& gt, const vector<motBox>& hyp, float min_iou){
+
+    motScores res;
+
+    std::map<int, vector<const motBox*>> gt_frames, hyp_frames;
+    std::map<int, int> gt_ids, hyp_ids;
+
+    for(const motBox& box: gt){
+        gt_frames[box.frame].push_back(&box);
+        gt_ids.emplace(box.id, gt_ids.size());
+    }
+    for(const motBox& box: hyp){
+        hyp_frames[box.frame].push_back(&box);
+        hyp_ids.emplace(box.id, hyp_ids.size());
+    }
+
+    /* Frames where each (ground truth, hypothesis) pair of tracks overlaps, for IDF1. */
+    const int n_gt = gt_ids.size(), n_hyp = hyp_ids.size();
+    vector<double> overlap((size_t)n_gt * n_hyp, 0.0);
+
+    /* Hypothesis last matched to every ground truth track. */
+    std::map<int, int> last_match;
+
+    for(const auto& frame: gt_frames){
+
+        const vector<const motBox*>& g = frame.second;
+        static const vector<const motBox*> none;
+        auto it = hyp_frames.find(frame.first);
+        const vector<const motBox*>& h = (it == hyp_frames.end()) ? none : it -> second;
+
+        const int m = g.size(), n = h.size();
+        vector<float> iou((size_t)m * n);
+
+        for(int i = 0; i < m; ++ i){
+            for(int j = 0; j < n; ++ j){
+
+                iou[(size_t)i * n + j] = boxIoU(*g[i], *h[j]);
+
+                if(iou[(size_t)i * n + j] >= min_iou){
+                    overlap[(size_t)gt_ids[g[i] -> id] * n_hyp + hyp_ids[h[j] -> id]] += 1.0;
+                }
+            }
+        }
+
+        vector<int> match(m, INVALID_INDEX);
+        vector<bool> hyp_used(n, false);
+
+        /* Keep the correspondences of the previous frame. */
+        for(int i = 0; i < m; ++ i){
+
+            auto last = last_match.find(g[i] -> id);
+            if(last == last_match.end()){
+                continue;
+            }
+
+            for(int j = 0; j < n; ++ j){
+
+                if(false == hyp_used[j] && h[j] -> id == last -> second && iou[(size_t)i * n + j] >= min_iou){
+                    match[i] = j;
+                    hyp_used[j] = true;
+                    break;
+                }
+            }
+        }
+
+        /* Match the rest by IoU. */
+        vector<int> free_g, free_h;
+        for(int i = 0; i < m; ++ i){
+            if(match[i] == INVALID_INDEX) free_g.push_back(i);
+        }
+        for(int j = 0; j < n; ++ j){
+            if(false == hyp_used[j]) free_h.push_back(j);
+        }
+
+        vector<double> weight(free_g.size() * free_h.size(), 0.0);
+        for(size_t a = 0; a < free_g.size(); ++ a){
+            for(size_t b = 0; b < free_h.size(); ++ b){
+
+                float v = iou[(size_t)free_g[a] * n + free_h[b]];
+                weight[a * free_h.size() + b] = v >= min_iou ? v : 0.0;
+            }
+        }
+
+        vector<int> new_match;
+        maxMatch(weight, free_g.size(), free_h.size(), new_match);
+
+        for(size_t a = 0; a < free_g.size(); ++ a){
+
+            if(new_match[a] == INVALID_INDEX){
+                continue;
+            }
+
+            int i = free_g[a], j = free_h[new_match[a]];
+            match[i] = j;
+            hyp_used[j] = true;
+
+            auto last = last_match.find(g[i] -> id);
+            if(last != last_match.end() && last -> second != h[j] -> id){
+                ++ res.idsw;
+            }
+        }
+
+        int matched = 0;
+        for(int i = 0; i < m; ++ i){
+
+            if(match[i] != INVALID_INDEX){
+                last_match[g[i] -> id] = h[match[i]] -> id;
+                ++ matched;
+            }
+        }
+
+        res.gt += m;
+        res.fn += m - matched;
+        res.fp += n - matched;
+    }
+
+    /* Hypotheses in frames without ground truth are all false positives. */
+    for(const auto& frame: hyp_frames){
+
+        if(gt_frames.find(frame.first) == gt_frames.end()){
+            res.fp += frame.second.size();
+        }
+    }
+
+    vector<int> id_match;
+    maxMatch(overlap, n_gt, n_hyp, id_match);
+
+    for(int i = 0; i < n_gt; ++ i){
+
+        if(id_match[i] != INVALID_INDEX){
+            res.idtp += (long)overlap[(size_t)i * n_hyp + id_match[i]];
+        }
+    }
+
+    res.mota = res.gt > 0 ? 1.0 - (double)(res.fn + res.fp + res.idsw) / res.gt : 0.0;
+    res.idf1 = (gt.size() + hyp.size()) > 0 ? 2.0 * res.idtp / (gt.size() + hyp.size()) : 0.0;
+
+    return res;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef _MOTMETRICS_H_
+#define _MOTMETRICS_H_
+
+#include "funcs.hpp"
+
+/* IoU a hypothesis needs with a ground truth box to count as a match. */
+#define EVAL_MIN_IOU (0.5f)
+
+
+/**
+ * @struct motBox
+ * @brief One box of a track in one frame, as in MOTChallenge files.
+ *
+ */
+struct motBox{
+
+    int frame;
+    int id;
+    float x;
+    float y;
+    float w;
+    float h;
+};
+
+
+/**
+ * @struct motScores
+ * @brief CLEAR MOT and identity scores of a tracking result against ground truth.
+ *
+ */
+struct motScores{
+
+    double mota = 0.0;
+    double idf1 = 0.0;
+
+    long gt = 0;
+    long fp = 0;
+    long fn = 0;
+    long idsw = 0;
+    long idtp = 0;
+};
+
+
+namespace func{
+
+    bool loadMOT(const string& path, vector<motBox>& boxes);
+    motScores evaluateMOT(const vector<motBox>& gt, const vector<motBox>& hyp, float min_iou = EVAL_MIN_IOU);
+}
+
+
+#endif
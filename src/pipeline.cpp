@@ -0,0 +1,30 @@
+/**
+ * @file pipeline.cpp
+ * @brief Building blocks of the multi-threaded frame loop.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "pipeline.hpp"
+
+
+/**
+ * @brief Print mean and worst busy time of the stage, and the frame rate it could sustain alone.
+ *
+ * @param name      Name of the stage.
+ *
+ */
+void stageStats::report(const char* name) const{
+
+    if(frames == 0){
+
+        cout << name << ": no frame" << endl;
+        return;
+    }
+
+    double mean_ms = total_ms / frames;
+
+    cout << name << ": " << frames << " frames, mean " << mean_ms << " ms, max " << max_ms
+        << " ms, up to " << (mean_ms > 0.0 ? 1000.0 / mean_ms : 0.0) << " fps" << endl;
+}
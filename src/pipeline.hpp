@@ -0,0 +1,156 @@
+#pragma once
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include "funcs.hpp"
+#include "detect.hpp"
+#include "track.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+/* Frame slots in flight between capture, detection, tracking and rendering.
+   More slots absorb jitter between the stages, at the cost of latency and memory. */
+#define PIPE_SLOTS (4)
+
+/* Size of a cache line, producer and consumer indices are kept apart. */
+#define CACHE_LINE (64)
+
+typedef std::chrono::steady_clock pipeClock;
+
+
+/**
+ * @class spscQueue
+ * @brief Bounded lock-free queue between exactly one producer thread and one consumer thread.
+ *
+ * One entry of the ring is always left empty, so that a full queue can be told from an empty one.
+ *
+ */
+template <class T>
+class spscQueue{
+
+public:
+
+    explicit spscQueue(int capacity): _ring(capacity + 1) {}
+
+    /* Non-blocking. Return `false` if the queue is full. */
+    bool tryPush(const T& item){
+
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) % _ring.size();
+
+        if(next == _head.load(std::memory_order_acquire)){
+            return false;
+        }
+
+        _ring[tail] = item;
+        _tail.store(next, std::memory_order_release);
+
+        return true;
+    }
+
+    /* Non-blocking. Return `false` if the queue is empty. */
+    bool tryPop(T& item){
+
+        size_t head = _head.load(std::memory_order_relaxed);
+
+        if(head == _tail.load(std::memory_order_acquire)){
+            return false;
+        }
+
+        item = _ring[head];
+        _head.store((head + 1) % _ring.size(), std::memory_order_release);
+
+        return true;
+    }
+
+    /* Blocking, yield the core while the queue is full. */
+    void push(const T& item){
+
+        while(false == tryPush(item)){
+            std::this_thread::yield();
+        }
+    }
+
+    /* Blocking, yield the core while the queue is empty. */
+    T pop(void){
+
+        T item;
+        while(false == tryPop(item)){
+            std::this_thread::yield();
+        }
+
+        return item;
+    }
+
+private:
+
+    vector<T> _ring;
+
+    /* Written by the consumer only. */
+    alignas(CACHE_LINE) std::atomic<size_t> _head{0};
+
+    /* Written by the producer only. */
+    alignas(CACHE_LINE) std::atomic<size_t> _tail{0};
+};
+
+
+/**
+ * @struct frameSlot
+ * @brief One frame in flight and what the stages found in it. Slots are allocated once and
+ *        recycled, so the frame buffer is reused by the decoder.
+ *
+ */
+struct frameSlot{
+
+    Mat frame;
+
+    /* Frame number, from 1. */
+    int index = 0;
+
+    /* Set by detection. `fd_objs` is only valid when `detected` is `true`. */
+    bool detected = false;
+    vector<fdObject> fd_objs;
+
+    /* Busy time of detection on this frame, in milliseconds. */
+    float detect_ms = 0.0f;
+
+    /* Set by tracking, the running trackers after this frame. */
+    vector<tcrResult> tcr_results;
+
+    /* End of stream. The slot carries no frame. */
+    bool last = false;
+
+    /* When capture of this frame started, for end-to-end latency. */
+    pipeClock::time_point t_read;
+};
+
+
+/**
+ * @struct stageStats
+ * @brief Busy time of one pipeline stage.
+ *
+ */
+struct stageStats{
+
+    double total_ms = 0.0;
+    double max_ms = 0.0;
+    long frames = 0;
+
+    void add(pipeClock::time_point start){
+
+        double ms = std::chrono::duration<double, std::milli>(pipeClock::now() - start).count();
+
+        total_ms += ms;
+        max_ms = std::max(max_ms, ms);
+        ++ frames;
+    }
+
+    void report(const char* name) const;
+};
+
+
+#endif
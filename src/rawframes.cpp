@@ -0,0 +1,224 @@
+/**
+ * @file rawframes.cpp
+ * @brief Raw frame containers, decode-free inputs for repeatable benchmarks.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "rawframes.hpp"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/**
+ * @brief Map a raw frame container. The source isn't opened if the file is not a valid container.
+ *
+ * @param path      Path to the container.
+ *
+ */
+rawSource::rawSource(const string& path){
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if(fd < 0){
+        return;
+    }
+
+    struct stat st;
+
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size >= RAW_DATA_OFFSET){
+
+        /* Private and writable, a stage writing into a frame gets its own copy of the page. */
+        void* map = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+        if(map != MAP_FAILED){
+
+            _map = (unsigned char*)map;
+            _map_size = st.st_size;
+        }
+    }
+
+    ::close(fd);
+
+    if(_map == nullptr){
+        return;
+    }
+
+    std::memcpy(&_header, _map, sizeof(_header));
+
+    bool valid = std::memcmp(_header.magic, RAW_MAGIC, sizeof(_header.magic)) == 0
+        && _header.width > 0 && _header.height > 0 && _header.frames >= 0
+        && (_header.channels == 1 || _header.channels == 3)
+        && _header.stride >= (int64_t)_header.width * _header.channels
+        && _header.frame_bytes == _header.stride * _header.height
+        && RAW_DATA_OFFSET + _header.frame_bytes * _header.frames <= (int64_t)_map_size;
+
+    if(false == valid){
+
+        munmap(_map, _map_size);
+        _map = nullptr;
+        return;
+    }
+
+    madvise(_map, _map_size, MADV_SEQUENTIAL);
+}
+
+rawSource::~rawSource(){
+
+    if(_map != nullptr){
+        munmap(_map, _map_size);
+    }
+}
+
+bool rawSource::isOpened(void) const{
+
+    return _map != nullptr;
+}
+
+int rawSource::frames(void) const{
+
+    return _header.frames;
+}
+
+/**
+ * @brief Hand out the next frame.
+ *
+ * @param frame     The frame. It refers to the mapping for BGR containers, and stays valid
+ *                  as long as the source. Gray containers are expanded into its own buffer. 
+ *                  This is the result of this function.
+ *
+ * @return Boolean value. Return `false` at the end of the container.
+ *
+ */
+bool rawSource::read(Mat& frame){
+
+    if(false == isOpened() || _next >= _header.frames){
+        return false;
+    }
+
+    unsigned char* data = _map + RAW_DATA_OFFSET + _header.frame_bytes * _next;
+    ++ _next;
+
+    if(_header.channels == 3){
+
+        frame = Mat(_header.height, _header.width, CV_8UC3, data, (size_t)_header.stride);
+    }
+    else{
+
+        /* Into the caller's buffer, frames still in flight keep their pixels. 
+           The buffer is reused once it has the right size. */
+        Mat gray(_header.height, _header.width, CV_8UC1, data, (size_t)_header.stride);
+        cv::cvtColor(gray, frame, cv::COLOR_GRAY2BGR);
+    }
+
+    return true;
+}
+
+
+rawWriter::~rawWriter(){
+
+    close();
+}
+
+/**
+ * @brief Create a container, with room for the header.
+ *
+ * @param path      Path to the container. An existing file is overwritten.
+ * @param size      Size of all the frames.
+ * @param gray      Whether frames are stored gray instead of BGR. Default value is `false`.
+ *
+ * @return Boolean value. Return `true` if the file is created.
+ *
+ */
+bool rawWriter::open(const string& path, Size size, bool gray){
+
+    close();
+
+    _file = std::fopen(path.c_str(), "wb");
+
+    if(_file == nullptr){
+        return false;
+    }
+
+    std::memcpy(_header.magic, RAW_MAGIC, sizeof(_header.magic));
+    _header.width = size.width;
+    _header.height = size.height;
+    _header.channels = gray ? 1 : 3;
+    _header.frames = 0;
+    _header.stride = ((int64_t)size.width * _header.channels + RAW_ROW_ALIGN - 1) / RAW_ROW_ALIGN * RAW_ROW_ALIGN;
+    _header.frame_bytes = _header.stride * size.height;
+
+    /* Padded frame, the padding bytes stay zero. */
+    _frame = Mat((int)size.height, (int)_header.stride, CV_8UC1, cv::Scalar(0));
+
+    vector<char> head(RAW_DATA_OFFSET, 0);
+    std::memcpy(head.data(), &_header, sizeof(_header));
+
+    return std::fwrite(head.data(), 1, head.size(), _file) == head.size();
+}
+
+/**
+ * @brief Append a BGR frame, converted to gray if the container is gray.
+ *
+ * @param frame     The frame, of the size given to `open`.
+ *
+ * @return Boolean value. Return `true` if the frame is written.
+ *
+ */
+bool rawWriter::write(const Mat& frame){
+
+    if(_file == nullptr || frame.cols != _header.width || frame.rows != _header.height
+        || frame.type() != CV_8UC3){
+        return false;
+    }
+
+    Mat pixels = _frame(Rect(0, 0, _header.width * _header.channels, _header.height))
+                    .reshape(_header.channels, _header.height);
+
+    if(_header.channels == 3){
+        frame.copyTo(pixels);
+    }
+    else{
+        cv::cvtColor(frame, pixels, cv::COLOR_BGR2GRAY);
+    }
+
+    if(std::fwrite(_frame.data, 1, _header.frame_bytes, _file) != (size_t)_header.frame_bytes){
+        return false;
+    }
+
+    ++ _header.frames;
+
+    return true;
+}
+
+/**
+ * @brief Write the final header and close the file. Nothing happens if it's not open.
+ *
+ * @return Boolean value. Return `true` if the container is complete.
+ *
+ */
+bool rawWriter::close(void){
+
+    if(_file == nullptr){
+        return false;
+    }
+
+    bool ok = std::fseek(_file, 0, SEEK_SET) == 0
+        && std::fwrite(&_header, sizeof(_header), 1, _file) == 1;
+
+    ok = (std::fclose(_file) == 0) && ok;
+    _file = nullptr;
+
+    return ok;
+}
+
+int rawWriter::frames(void) const{
+
+    return _header.frames;
+}
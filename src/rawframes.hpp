@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef _RAWFRAMES_H_
+#define _RAWFRAMES_H_
+
+#include "funcs.hpp"
+#include "source.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+/* Extension of raw frame containers, `frameSource::open` picks them by it. */
+#define RAW_EXT ".mraw"
+
+#define RAW_MAGIC "MOTRAW01"
+
+/* Frames start at this offset, and rows at a multiple of `RAW_ROW_ALIGN` bytes. */
+#define RAW_DATA_OFFSET (4096)
+#define RAW_ROW_ALIGN (64)
+
+
+/**
+ * @struct rawHeader
+ * @brief Header of a raw frame container.
+ *
+ * The file is the header, padding up to `RAW_DATA_OFFSET`, then `frames` frames of
+ * `height` rows of `stride` bytes each. Pixels are 8 bit, BGR or gray.
+ *
+ */
+struct rawHeader{
+
+    char magic[8];
+    int32_t width;
+    int32_t height;
+    int32_t channels;
+    int32_t frames;
+    int64_t stride;
+    int64_t frame_bytes;
+};
+
+
+/**
+ * @class rawSource
+ * @brief Raw frame container mapped in memory. BGR frames are handed out as `Mat` headers over
+ *        the mapping, without a copy. Gray frames are expanded to BGR into the caller's buffer.
+ *
+ */
+class rawSource: public frameSource{
+
+public:
+
+    explicit rawSource(const string& path);
+    ~rawSource();
+
+    bool read(Mat& frame) override;
+    bool isOpened(void) const override;
+
+    int frames(void) const;
+
+private:
+
+    rawHeader _header = rawHeader();
+
+    unsigned char* _map = nullptr;
+    size_t _map_size = 0;
+
+    int _next = 0;
+};
+
+
+/**
+ * @class rawWriter
+ * @brief Writes a raw frame container. The frame count is filled in by `close`.
+ *
+ */
+class rawWriter{
+
+public:
+
+    rawWriter() {}
+    ~rawWriter();
+
+    bool open(const string& path, Size size, bool gray = false);
+    bool write(const Mat& frame);
+    bool close(void);
+
+    int frames(void) const;
+
+private:
+
+    std::FILE* _file = nullptr;
+    rawHeader _header = rawHeader();
+
+    /* One frame as it is stored, rows padded to the stride. */
+    Mat _frame;
+};
+
+
+#endif
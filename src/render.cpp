@@ -0,0 +1,66 @@
+/**
+ * @file render.cpp
+ * @brief Draws the results of the MOT system, apart from the processing.
+ * @author wantSomeChips
+ * @date 2025
+ * 
+ */
+
+#include "render.hpp"
+
+#include <cstdio>
+
+/**
+ * @brief Draw Detection and Tracking results on a copy of the frame.
+ *
+ * Trackers get their id above the box, APCE and peak below it. Detected objects are drawn last.
+ *
+ * @param frame         The frame the results come from. It's not modified.
+ * @param fd_objs       Detected objects, `nullptr` when Detection was skipped for this frame.
+ * @param tcr_results   Results of the running trackers.
+ * @param canvas        Copy of the frame with the results drawn. This is the result of this function.
+ *                      Its buffer is reused from one call to the next.
+ * 
+ * @return Boolean value. Return `true` if the drawing goes on properly. 
+ * 
+ */
+bool func::render(const Mat& frame, const vector<fdObject>* fd_objs, const vector<tcrResult>& tcr_results, 
+    Mat& canvas){
+
+    frame.copyTo(canvas);
+
+    for(const tcrResult& res: tcr_results){
+
+        const Rect& bbox = res.roi;
+
+        char title[16];
+        snprintf(title, sizeof(title), "id:%02d", res.id);
+
+        char apce_datas[23];
+        snprintf(apce_datas, sizeof(apce_datas), "APCE: %04.1f / %04.1f %c",
+                    res.apce, res.mean_apce, res.accepted? 'T' : 'F');
+
+        char peak_datas[20];
+        snprintf(peak_datas, sizeof(peak_datas), "Peak: %04.1f / %04.1f",
+                    res.peak * 100, res.mean_peak * 100);
+
+        cv::putText(canvas, title, cv::Point(bbox.x, bbox.y - 1),cv::FONT_HERSHEY_SIMPLEX,
+                             0.5, cv::Scalar(0,0,255), 1, cv::LINE_AA);
+        cv::putText(canvas, apce_datas, cv::Point(bbox.x,bbox.y + bbox.height + 13),cv::FONT_HERSHEY_SIMPLEX,
+                             0.3, cv::Scalar(0,255,0), 1, cv::LINE_AA);
+        cv::putText(canvas, peak_datas, cv::Point(bbox.x,bbox.y + bbox.height + 13 * 2),cv::FONT_HERSHEY_SIMPLEX,
+                             0.3, cv::Scalar(0,255,0), 1, cv::LINE_AA);
+        cv::rectangle(canvas,bbox, cv::Scalar(0,0,255));
+    }
+
+    if(fd_objs != nullptr){
+
+        /* Only for testing object detection. */
+        for(const fdObject& fd_obj: *fd_objs){
+            /* Blue(FD). */
+            cv::rectangle(canvas,fd_obj.resultRect(),cv::Scalar(255,0,0));
+        }
+    }
+
+    return true;
+}
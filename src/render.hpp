@@ -0,0 +1,17 @@
+#pragma once
+
+#ifndef _RENDER_H_
+#define _RENDER_H_
+
+#include "funcs.hpp"
+#include "detect.hpp"
+#include "track.hpp"
+
+namespace func{
+
+    bool render(const Mat& frame, const vector<fdObject>* fd_objs, const vector<tcrResult>& tcr_results, 
+        Mat& canvas);
+}
+
+
+#endif
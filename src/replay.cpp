@@ -0,0 +1,264 @@
+/**
+ * @file replay.cpp
+ * @brief Records the MOT system, and replays the recording into one stage alone.
+ * @author wantSomeChips
+ * @date 2025
+ * 
+ * Usage: 
+ * - `replay record <input> <log> [key=value ...]` runs the MOT system headless and records 
+ *   the detections and tracks of every frame.
+ * - `replay track <log> <input> [key=value ...]` feeds the recorded detections into Tracking, 
+ *   without running Detection. Frames still come from the input, the trackers need them.
+ * - `replay assoc <log> [--repeat=N]` matches the recorded tracks of each frame with the 
+ *   recorded detections of the next one, without frames, Detection or trackers.
+ * 
+ */
+
+#include "funcs.hpp"
+#include "config.hpp"
+#include "source.hpp"
+#include "pipeline.hpp"
+#include "replaylog.hpp"
+
+#include <string>
+#include <cstring>
+using std::string;
+
+
+/**
+ * @brief Replay recorded detections into Tracking, and compare its results with the recorded ones.
+ *
+ * @return Boolean value. Return `false` if the log or the input can't be read.
+ *
+ */
+static bool replayTrack(const string& log, const string& input, const motConfig& cfg){
+
+    replayReader reader;
+    frameSource* source = frameSource::open(input);
+
+    if(false == reader.open(log) || source == nullptr){
+
+        std::cerr << "ERRO: Failed to Open: " << log << ", " << input << endl;
+        delete source;
+        return false;
+    }
+
+    objTrack track(cfg.track);
+
+    replayFrame rec;
+    vector<tcrResult> results;
+    stageStats track_stats;
+
+    Mat frame;
+    int index = 0;
+    long compared = 0, differing = 0;
+
+    while(reader.read(rec)){
+
+        /* Recordings start after the first frame, which only initializes Detection. */
+        bool ok = true;
+        while(ok && index < rec.index){
+            ok = source -> read(frame);
+            ++ index;
+        }
+
+        if(false == ok){
+            break;
+        }
+
+        pipeClock::time_point t_start = pipeClock::now();
+
+        if(rec.detected){
+            track.tick(frame, rec.fd_objs);
+        }
+        else{
+            track.tick(frame);
+        }
+
+        track_stats.add(t_start);
+
+        if(false == rec.tracked){
+            continue;
+        }
+
+        track.getResults(results);
+        ++ compared;
+
+        bool same = results.size() == rec.tcr_results.size();
+        for(size_t i = 0; same && i < results.size(); ++ i){
+            same = results[i].id == rec.tcr_results[i].id && results[i].roi == rec.tcr_results[i].roi;
+        }
+
+        if(false == same){
+            ++ differing;
+        }
+    }
+
+    track_stats.report("Tracking");
+
+    /* The update budget depends on measured time, so deferred updates may differ between runs. */
+    if(compared > 0){
+        cout << "Frames differing from the recording: " << differing << " of " << compared << endl;
+    }
+
+    delete source;
+    return true;
+}
+
+/**
+ * @brief Replay recorded tracks and detections into association: IoU costs and matching.
+ *
+ * Tracks of a frame stand for the trackers that the detections of the next frame are matched 
+ * with. Appearance needs the trackers' models, so the costs are from IoU only.
+ *
+ * @return Boolean value. Return `false` if the log can't be read or has no tracks.
+ *
+ */
+static bool replayAssoc(const string& log, int repeat){
+
+    replayReader reader;
+
+    if(false == reader.open(log)){
+
+        std::cerr << "ERRO: Failed to Open: " << log << endl;
+        return false;
+    }
+
+    /* Detections of a frame, and the tracks of the frame before. */
+    vector<std::pair<vector<fdObject>, vector<tcrResult>>> rounds;
+
+    replayFrame rec;
+    vector<tcrResult> last_tracks;
+    bool tracked = false;
+
+    while(reader.read(rec)){
+
+        if(rec.detected && false == last_tracks.empty()){
+            rounds.emplace_back(rec.fd_objs, last_tracks);
+        }
+
+        tracked = tracked || rec.tracked;
+        last_tracks = rec.tcr_results;
+    }
+
+    if(false == tracked){
+
+        std::cerr << "ERRO: No Tracks Recorded: " << log << endl;
+        return false;
+    }
+
+    objTrack track{trackConfig()};
+    stageStats assoc_stats;
+    long matched = 0;
+
+    vector<float> fd_x, fd_y, fd_w, fd_h, tcr_x, tcr_y, tcr_w, tcr_h;
+    vector<int> matched_tcr_row;
+
+    for(int r = 0; r < repeat; ++ r){
+
+        for(const auto& round: rounds){
+
+            const vector<fdObject>& fd_objs = round.first;
+            const vector<tcrResult>& tcrs = round.second;
+            const int n = fd_objs.size(), m = tcrs.size();
+
+            pipeClock::time_point t_start = pipeClock::now();
+
+            fd_x.resize(n); fd_y.resize(n); fd_w.resize(n); fd_h.resize(n);
+            for(int i = 0; i < n; ++ i){
+
+                Rect roi = fd_objs[i].resultRect();
+                fd_x[i] = roi.x; fd_y[i] = roi.y; fd_w[i] = roi.width; fd_h[i] = roi.height;
+            }
+
+            tcr_x.resize(m); tcr_y.resize(m); tcr_w.resize(m); tcr_h.resize(m);
+            for(int i = 0; i < m; ++ i){
+
+                const Rect& roi = tcrs[i].roi;
+                tcr_x[i] = roi.x; tcr_y[i] = roi.y; tcr_w[i] = roi.width; tcr_h[i] = roi.height;
+            }
+
+            const boxArrays tcr_boxes = {tcr_x.data(), tcr_y.data(), tcr_w.data(), tcr_h.data(), m};
+            const boxArrays fd_boxes = {fd_x.data(), fd_y.data(), fd_w.data(), fd_h.data(), n};
+
+            Mat cost(Size(n, m), CV_32FC1);
+            func::IoUMatrix(tcr_boxes, fd_boxes, cost.ptr<float>(0), cost.step1());
+            cost = 1.0f - cost;
+
+            track.hungarianMatch(fd_objs, cost, matched_tcr_row);
+
+            assoc_stats.add(t_start);
+
+            if(r == 0){
+                matched += n - std::count(matched_tcr_row.begin(), matched_tcr_row.end(), INVALID_INDEX);
+            }
+        }
+    }
+
+    assoc_stats.report("Association");
+    cout << "Matched detections: " << matched << " in " << rounds.size() << " frames" << endl;
+
+    return true;
+}
+
+/**
+ * @brief Read `key=value` settings from the arguments starting at `first`.
+ *
+ * @return Boolean value. Return `false` if one is not a valid setting, or a value is out of range.
+ *
+ */
+static bool parseSettings(int argc, char* argv[], int first, motConfig& cfg){
+
+    for(int i = first; i < argc; ++ i){
+
+        if(false == cfg.set(argv[i])){
+
+            std::cerr << "ERROR: Unknown setting: " << argv[i] << endl;
+            return false;
+        }
+    }
+
+    string error;
+    if(false == cfg.validate(error)){
+
+        std::cerr << "ERROR: Invalid settings: " << error << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+int main(int argc, char* argv[]){
+
+    string mode = argc > 1 ? argv[1] : "";
+    motConfig cfg;
+
+    if(mode == "record" && argc >= 4){
+
+        if(false == parseSettings(argc, argv, 4, cfg)){
+            return ERR_ARG_NUM;
+        }
+        return func::MOT(argv[2], cfg, false, "", argv[3]) ? 0 : 1;
+    }
+
+    if(mode == "track" && argc >= 4){
+
+        if(false == parseSettings(argc, argv, 4, cfg)){
+            return ERR_ARG_NUM;
+        }
+        return replayTrack(argv[2], argv[3], cfg) ? 0 : 1;
+    }
+
+    if(mode == "assoc" && (argc == 3 || (argc == 4 && strncmp(argv[3], "--repeat=", 9) == 0))){
+
+        int repeat = argc == 4 ? std::max(std::atoi(argv[3] + 9), 1) : 1;
+        return replayAssoc(argv[2], repeat) ? 0 : 1;
+    }
+
+    std::cerr << "Usage: replay record <input> <log> [key=value ...]" << endl
+              << "       replay track <log> <input> [key=value ...]" << endl
+              << "       replay assoc <log> [--repeat=N]" << endl;
+
+    return ERR_ARG_NUM;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file replaylog.cpp
+ * @brief Record and read back the output of Detection and Tracking, to replay one stage alone.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "replaylog.hpp"
+
+#include <cstring>
+
+
+replayWriter::~replayWriter(){
+
+    close();
+}
+
+/**
+ * @brief Create a replay log.
+ *
+ * @param path      Path to the log. An existing file is overwritten.
+ *
+ * @return Boolean value. Return `true` if the file is created.
+ *
+ */
+bool replayWriter::open(const string& path){
+
+    close();
+
+    _file = std::fopen(path.c_str(), "wb");
+
+    if(_file == nullptr){
+        return false;
+    }
+
+    return std::fwrite(REPLAY_MAGIC, 1, strlen(REPLAY_MAGIC), _file) == strlen(REPLAY_MAGIC);
+}
+
+/**
+ * @brief Append one frame.
+ *
+ * @param frame         Frame number, from 1.
+ * @param fd_objs       Detected objects, `nullptr` if Detection skipped this frame.
+ * @param tcr_results   Results of the running trackers, `nullptr` to leave them out.
+ *
+ * @return Boolean value. Return `true` if the frame is written.
+ *
+ */
+bool replayWriter::write(int frame, const vector<fdObject>* fd_objs, const vector<tcrResult>* tcr_results){
+
+    if(_file == nullptr){
+        return false;
+    }
+
+    _objects.clear();
+    _tracks.clear();
+
+    if(fd_objs != nullptr){
+
+        for(const fdObject& obj: *fd_objs){
+
+            Rect roi = obj.resultRect();
+            _objects.push_back({roi.x, roi.y, roi.width, roi.height});
+        }
+    }
+
+    if(tcr_results != nullptr){
+
+        for(const tcrResult& res: *tcr_results){
+
+            _tracks.push_back({frame, res.id, (float)res.roi.x, (float)res.roi.y, 
+                (float)res.roi.width, (float)res.roi.height, res.apce, res.peak, 
+                (int8_t)res.state, (int8_t)res.accepted, 0, 0});
+        }
+    }
+
+    replayFrameHeader header = {frame, fd_objs != nullptr, (int32_t)_objects.size(), 
+        tcr_results != nullptr ? (int32_t)_tracks.size() : REPLAY_NO_TRACKS};
+
+    return std::fwrite(&header, sizeof(header), 1, _file) == 1
+        && std::fwrite(_objects.data(), sizeof(detectionRecord), _objects.size(), _file) == _objects.size()
+        && std::fwrite(_tracks.data(), sizeof(trackRecord), _tracks.size(), _file) == _tracks.size();
+}
+
+/**
+ * @brief Close the log. Nothing happens if it's not open.
+ *
+ * @return Boolean value. Return `true` if all of the log reached the file.
+ *
+ */
+bool replayWriter::close(void){
+
+    if(_file == nullptr){
+        return false;
+    }
+
+    bool ok = std::fclose(_file) == 0;
+    _file = nullptr;
+
+    return ok;
+}
+
+
+replayReader::~replayReader(){
+
+    if(_file != nullptr){
+        std::fclose(_file);
+    }
+}
+
+/**
+ * @brief Open a replay log.
+ *
+ * @param path      Path to the log.
+ *
+ * @return Boolean value. Return `false` if the file can't be read or is not a replay log.
+ *
+ */
+bool replayReader::open(const string& path){
+
+    if(_file != nullptr){
+        std::fclose(_file);
+    }
+
+    _file = std::fopen(path.c_str(), "rb");
+
+    if(_file == nullptr){
+        return false;
+    }
+
+    char magic[sizeof(REPLAY_MAGIC) - 1];
+
+    if(std::fread(magic, 1, sizeof(magic), _file) != sizeof(magic) 
+        || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0){
+
+        std::fclose(_file);
+        _file = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read the next frame.
+ *
+ * @param frame     The frame. Its vectors are reused. This is the result of this function.
+ *
+ * @return Boolean value. Return `false` at the end of the log, or if it's truncated.
+ *
+ */
+bool replayReader::read(replayFrame& frame){
+
+    replayFrameHeader header;
+
+    if(_file == nullptr || std::fread(&header, sizeof(header), 1, _file) != 1
+        || header.objects < 0 || header.tracks < REPLAY_NO_TRACKS){
+        return false;
+    }
+
+    _objects.resize(header.objects);
+    _tracks.resize(std::max(header.tracks, 0));
+
+    if(std::fread(_objects.data(), sizeof(detectionRecord), _objects.size(), _file) != _objects.size()
+        || std::fread(_tracks.data(), sizeof(trackRecord), _tracks.size(), _file) != _tracks.size()){
+        return false;
+    }
+
+    frame.index = header.frame;
+    frame.detected = header.detected != 0;
+    frame.tracked = header.tracks != REPLAY_NO_TRACKS;
+
+    frame.fd_objs.clear();
+    for(const detectionRecord& obj: _objects){
+        frame.fd_objs.push_back(fdObject(Rect(obj.x, obj.y, obj.w, obj.h)));
+    }
+
+    frame.tcr_results.clear();
+    for(const trackRecord& rec: _tracks){
+
+        Rect roi(cvRound(rec.x), cvRound(rec.y), cvRound(rec.w), cvRound(rec.h));
+        frame.tcr_results.push_back({rec.id, roi, (char)rec.state, rec.apce, rec.apce, 
+            rec.peak, rec.peak, rec.accepted != 0});
+    }
+
+    return true;
+}
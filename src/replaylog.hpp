@@ -0,0 +1,122 @@
+#pragma once
+
+#ifndef _REPLAYLOG_H_
+#define _REPLAYLOG_H_
+
+#include "funcs.hpp"
+#include "detect.hpp"
+#include "track.hpp"
+#include "tracksink.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+#define REPLAY_MAGIC "MOTREP01"
+
+/* `tracks` of a frame recorded without tracker results. */
+#define REPLAY_NO_TRACKS (-1)
+
+
+/**
+ * @struct replayFrameHeader
+ * @brief Header of one frame in a replay log.
+ *
+ * The log is `REPLAY_MAGIC`, then one header per frame, followed by `objects` 
+ * `detectionRecord`s and `tracks` `trackRecord`s.
+ *
+ */
+struct replayFrameHeader{
+
+    int32_t frame;
+    int32_t detected;
+    int32_t objects;
+    int32_t tracks;
+};
+
+
+/**
+ * @struct detectionRecord
+ * @brief Bounding box of one detected object in a replay log.
+ *
+ */
+struct detectionRecord{
+
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+};
+
+
+/**
+ * @struct replayFrame
+ * @brief What the stages found in one frame, as read back from a replay log.
+ *
+ */
+struct replayFrame{
+
+    /* Frame number, from 1. */
+    int index = 0;
+
+    /* `fd_objs` is only valid when `detected` is `true`, as in `frameSlot`. */
+    bool detected = false;
+    vector<fdObject> fd_objs;
+
+    /* Running trackers after this frame, if they were recorded. Running means are not 
+       recorded, they read back as the values of this frame. */
+    bool tracked = false;
+    vector<tcrResult> tcr_results;
+};
+
+
+/**
+ * @class replayWriter
+ * @brief Records detections and, optionally, tracker results frame by frame.
+ *
+ */
+class replayWriter{
+
+public:
+
+    replayWriter() {}
+    ~replayWriter();
+
+    bool open(const string& path);
+    bool write(int frame, const vector<fdObject>* fd_objs, const vector<tcrResult>* tcr_results);
+    bool close(void);
+
+private:
+
+    std::FILE* _file = nullptr;
+
+    /* Records of one frame, reused. */
+    vector<detectionRecord> _objects;
+    vector<trackRecord> _tracks;
+};
+
+
+/**
+ * @class replayReader
+ * @brief Reads a replay log back, frame by frame.
+ *
+ */
+class replayReader{
+
+public:
+
+    replayReader() {}
+    ~replayReader();
+
+    bool open(const string& path);
+    bool read(replayFrame& frame);
+
+private:
+
+    std::FILE* _file = nullptr;
+
+    vector<detectionRecord> _objects;
+    vector<trackRecord> _tracks;
+};
+
+
+#endif
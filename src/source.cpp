@@ -0,0 +1,223 @@
+/**
+ * @file source.cpp
+ * @brief Inputs of the MOT system: camera, video or image sequence.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "source.hpp"
+#include "rawframes.hpp"
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+
+/**
+ * @brief Open the input of the MOT system.
+ *
+ * @param input     A camera index, a video, a printf-style image sequence pattern or a raw 
+ *                  frame container (`RAW_EXT`).
+ *
+ * @return The opened source, or `nullptr` if it can't be opened. The caller takes the ownership.
+ *
+ */
+frameSource* frameSource::open(const string& input){
+
+    frameSource* source = nullptr;
+
+    /* Input is a camera. */
+    if(std::isdigit(input[0])){
+
+        source = new captureSource(std::stoi(input));
+    }
+    /* Input is a raw frame container. */
+    else if(input.size() > strlen(RAW_EXT) && input.compare(input.size() - strlen(RAW_EXT), string::npos, RAW_EXT) == 0){
+
+        source = new rawSource(input);
+    }
+    /* Input is an image sequence. */
+    else if(input.find('%') != string::npos){
+
+        source = new sequenceSource(input);
+    }
+    /* Input is a video. */
+    else{
+
+        source = new captureSource(input);
+    }
+
+    if(false == source -> isOpened()){
+
+        delete source;
+        return nullptr;
+    }
+
+    return source;
+}
+
+
+captureSource::captureSource(int cam_index): _cap(cam_index) {}
+
+captureSource::captureSource(const string& path): _cap(path) {}
+
+bool captureSource::read(Mat& frame){
+
+    return _cap.read(frame);
+}
+
+bool captureSource::isOpened(void) const{
+
+    return _cap.isOpened();
+}
+
+
+/**
+ * @brief Find the first frame of the sequence and start the decoding threads.
+ *
+ * @param pattern   printf-style pattern of the file names, with one integer conversion.
+ * @param threads   Number of decoding threads. Default value is `SEQ_DECODE_THREADS`.
+ * @param depth     Number of frames decoded ahead. Default value is `SEQ_PREFETCH`.
+ *
+ */
+sequenceSource::sequenceSource(const string& pattern, int threads, int depth)
+    : _pattern(pattern), _slots(std::max(depth, 1)){
+
+    for(int i = 0; i <= SEQ_MAX_START; ++ i){
+
+        if(std::ifstream(pathOf(i)).good()){
+
+            _start = i;
+            break;
+        }
+    }
+
+    if(_start == INVALID_INDEX){
+        return;
+    }
+
+    for(int i = 0; i < std::max(threads, 1); ++ i){
+        _workers.emplace_back(&sequenceSource::work, this);
+    }
+}
+
+sequenceSource::~sequenceSource(){
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cond.notify_all();
+
+    for(std::thread& worker: _workers){
+        worker.join();
+    }
+}
+
+bool sequenceSource::isOpened(void) const{
+
+    return _start != INVALID_INDEX;
+}
+
+/**
+ * @brief Hand out the next frame in order, waiting for it to be decoded if needed.
+ *
+ * The buffer of `frame` goes to the reorder buffer in exchange, to be decoded into later.
+ *
+ * @param frame     The frame. This is the result of this function.
+ *
+ * @return Boolean value. Return `false` at the end of the sequence.
+ *
+ */
+bool sequenceSource::read(Mat& frame){
+
+    if(false == isOpened()){
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    decodeSlot& slot = _slots[_next_read % _slots.size()];
+    _cond.wait(lock, [&](){ return slot.index == _next_read; });
+
+    if(slot.end){
+        return false;
+    }
+
+    cv::swap(frame, slot.frame);
+    slot.index = INVALID_INDEX;
+    ++ _next_read;
+
+    lock.unlock();
+    _cond.notify_all();
+
+    return true;
+}
+
+/**
+ * @brief Decoding thread. Claims the next frame, waits for its slot to be read,
+ *        then loads and decodes the file outside the lock.
+ *
+ */
+void sequenceSource::work(void){
+
+    /* Encoded file, reused across frames. */
+    vector<char> bytes;
+
+    for(;;){
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        int index = _next_decode ++;
+        _cond.wait(lock, [&](){
+            return _stop || index >= _end_index || index - _next_read < (int)_slots.size(); });
+
+        if(_stop || index >= _end_index){
+            return;
+        }
+
+        /* The slot was read, no one else touches it until it is marked. */
+        decodeSlot& slot = _slots[index % _slots.size()];
+        lock.unlock();
+
+        bool ok = false;
+        std::ifstream file(pathOf(_start + index), std::ios::binary | std::ios::ate);
+
+        if(file.good()){
+
+            std::streamsize size = file.tellg();
+            bytes.resize(size);
+            file.seekg(0);
+
+            if(size > 0 && file.read(bytes.data(), size)){
+
+                cv::imdecode(Mat(1, (int)size, CV_8U, bytes.data()), cv::IMREAD_COLOR, &slot.frame);
+                ok = (false == slot.frame.empty());
+            }
+        }
+
+        lock.lock();
+
+        slot.index = index;
+        slot.end = (false == ok);
+        if(slot.end){
+            _end_index = std::min(_end_index, index + 1);
+        }
+
+        lock.unlock();
+        _cond.notify_all();
+    }
+}
+
+/**
+ * @brief File name of frame `index` of the sequence.
+ *
+ */
+string sequenceSource::pathOf(int index) const{
+
+    vector<char> name(_pattern.size() + 32);
+    std::snprintf(name.data(), name.size(), _pattern.c_str(), index);
+
+    return string(name.data());
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#ifndef _SOURCE_H_
+#define _SOURCE_H_
+
+#include "funcs.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <climits>
+
+/* Decoding threads of an image-sequence input. */
+#define SEQ_DECODE_THREADS (2)
+
+/* Frames an image-sequence input decodes ahead of the reader. */
+#define SEQ_PREFETCH (8)
+
+/* Highest first index searched for an image sequence, as `cv::VideoCapture` does. */
+#define SEQ_MAX_START (1000)
+
+
+/**
+ * @class frameSource
+ * @brief Input of the MOT system, frames are read one after another in order.
+ *
+ */
+class frameSource{
+
+public:
+
+    virtual ~frameSource() {}
+
+    /* Read the next frame into `frame`, reusing its buffer where possible.
+       Return `false` at the end of the input. */
+    virtual bool read(Mat& frame) = 0;
+
+    virtual bool isOpened(void) const = 0;
+
+    static frameSource* open(const string& input);
+};
+
+
+/**
+ * @class captureSource
+ * @brief Camera or video file, read through `cv::VideoCapture`.
+ *
+ */
+class captureSource: public frameSource{
+
+public:
+
+    explicit captureSource(int cam_index);
+    explicit captureSource(const string& path);
+
+    bool read(Mat& frame) override;
+    bool isOpened(void) const override;
+
+private:
+
+    cv::VideoCapture _cap;
+};
+
+
+/**
+ * @class sequenceSource
+ * @brief Image sequence named by a printf-style pattern, such as `img1/%06d.jpg`.
+ *
+ * A pool of worker threads decodes up to `depth` frames ahead into a reorder buffer,
+ * and frames are handed out in index order. Buffers go round between the reader and the
+ * reorder buffer, so decoding allocates nothing once the sizes settle.
+ *
+ */
+class sequenceSource: public frameSource{
+
+public:
+
+    sequenceSource(const string& pattern, int threads = SEQ_DECODE_THREADS, int depth = SEQ_PREFETCH);
+    ~sequenceSource();
+
+    bool read(Mat& frame) override;
+    bool isOpened(void) const override;
+
+private:
+
+    /* One frame of the reorder buffer. Frame `i` goes to slot `i % depth`. */
+    struct decodeSlot{
+
+        Mat frame;
+
+        /* Index of the frame held, `INVALID_INDEX` while being decoded. */
+        int index = INVALID_INDEX;
+
+        /* The file is missing or can't be decoded, the sequence ends here. */
+        bool end = false;
+    };
+
+    void work(void);
+    string pathOf(int index) const;
+
+    string _pattern;
+    int _start = INVALID_INDEX;
+
+    vector<decodeSlot> _slots;
+    vector<std::thread> _workers;
+
+    /* Guards everything below and the slots' `index` and `end`. */
+    std::mutex _mutex;
+    std::condition_variable _cond;
+
+    int _next_read = 0;
+    int _next_decode = 0;
+    int _end_index = INT_MAX;
+    bool _stop = false;
+};
+
+
+#endif
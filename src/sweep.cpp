@@ -0,0 +1,290 @@
+/**
+ * @file sweep.cpp
+ * @brief Runs the MOT system over a grid of settings and scores each against ground truth.
+ * @author wantSomeChips
+ * @date 2025
+ * 
+ * Usage: `sweep <gt.txt> <input> [--jobs=N] key=v1,v2,... ...`
+ * 
+ * Every combination of the listed values is one job. Jobs run single-threaded, side by side on 
+ * the worker pool, so use a raw frame container (see `mkraw`) as input to keep decoding out of 
+ * the timings. The table lists the throughput and accuracy of each job, best throughput first, 
+ * and marks with `*` the settings no other job beats on throughput, MOTA and IDF1 all at once.
+ * Settings that fail to run are reported on stderr and left out of the table.
+ * 
+ */
+
+#include "funcs.hpp"
+#include "config.hpp"
+#include "source.hpp"
+#include "pipeline.hpp"
+#include "workerpool.hpp"
+#include "motmetrics.hpp"
+
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <memory>
+#include <algorithm>
+using std::string;
+
+
+/**
+ * @struct sweepJob
+ * @brief One point of the grid and how it did.
+ *
+ */
+struct sweepJob{
+
+    motConfig cfg;
+
+    bool ok = false;
+    string error;
+    double fps = 0.0;
+    motScores scores;
+    bool pareto = false;
+};
+
+
+/**
+ * @brief Track the whole input with one configuration, without rendering.
+ *
+ * @param input     Input of the MOT system.
+ * @param job       The configuration. Throughput is filled in, or the error if it fails.
+ * @param hyp       Boxes of the running trackers in every frame. This is the result of this function.
+ *
+ * @return Boolean value. Return `false` if the input can't be opened or the settings are rejected.
+ *
+ */
+static bool runJob(const string& input, sweepJob& job, vector<motBox>& hyp){
+
+    /* Out of range settings are reported as a failed job. */
+    if(false == job.cfg.validate(job.error)){
+        return false;
+    }
+
+    frameSource* source = frameSource::open(input);
+    Mat frame;
+
+    if(source == nullptr || false == source -> read(frame)){
+
+        job.error = "Failed to Open Input: " + input;
+        delete source;
+        return false;
+    }
+
+    stageStats busy;
+
+    /* The jobs run on the worker pool, where an exception would terminate the whole sweep. 
+       OpenCV throws `cv::Exception` for settings it can't work with, e.g. tiny KCF templates. */
+    try{
+
+        objDetect detect(frame, job.cfg.detect);
+        objTrack track(job.cfg.track);
+
+        vector<tcrResult> results;
+
+        /* The first frame went to the detector, numbering goes on from 2 as in `func::MOT`. */
+        for(int index = 2; source -> read(frame); ++ index){
+
+            pipeClock::time_point start = pipeClock::now();
+
+            if(detect.tick(frame)){
+                track.tick(frame, detect.getObjects());
+            }
+            else{
+                track.tick(frame);
+            }
+
+            detect.setFeedback(track.getWeakCount(), 
+                std::chrono::duration<float, std::milli>(pipeClock::now() - start).count());
+            busy.add(start);
+
+            track.getResults(results);
+            for(const tcrResult& res: results){
+                hyp.push_back({index, res.id, (float)res.roi.x, (float)res.roi.y,
+                               (float)res.roi.width, (float)res.roi.height});
+            }
+        }
+    }
+    catch(const std::exception& e){
+
+        job.error = e.what();
+        delete source;
+        return false;
+    }
+
+    job.fps = busy.total_ms > 0.0 ? 1000.0 * busy.frames / busy.total_ms : 0.0;
+
+    delete source;
+    return true;
+}
+
+/**
+ * @brief Add the cartesian product of `key=v1,v2,...` to the grid.
+ *
+ * @return Boolean value. Return `false` if the key or a value is invalid.
+ *
+ */
+static bool expand(const string& arg, vector<motConfig>& grid){
+
+    size_t eq = arg.find('=');
+    string key = arg.substr(0, eq);
+
+    vector<double> values;
+    std::istringstream list(arg.substr(eq + 1));
+    string item;
+
+    while(std::getline(list, item, ',')){
+
+        try{
+            values.push_back(std::stod(item));
+        }
+        catch(const std::exception&){
+            return false;
+        }
+    }
+
+    if(values.empty()){
+        return false;
+    }
+
+    vector<motConfig> next;
+
+    for(const motConfig& cfg: grid){
+        for(double value: values){
+
+            next.push_back(cfg);
+            if(false == next.back().set(key, value)){
+                return false;
+            }
+        }
+    }
+
+    grid.swap(next);
+
+    return true;
+}
+
+
+int main(int argc, char* argv[]){
+
+    if(argc < 3){
+        std::cerr << "Usage: sweep <gt.txt> <input> [--jobs=N] key=v1,v2,... ..." << endl;
+        return ERR_ARG_NUM;
+    }
+
+    vector<motBox> gt;
+
+    if(false == func::loadMOT(argv[1], gt)){
+
+        std::cerr << "ERRO: Failed to Read Ground Truth: " << argv[1] << endl;
+        return 1;
+    }
+
+    string input = argv[2];
+    vector<motConfig> grid(1);
+    /* Jobs run side by side, 0 for one per core. */
+    int jobs = 0;
+
+    for(int i = 3; i < argc; ++ i){
+
+        string arg = argv[i];
+
+        if(arg.compare(0, 7, "--jobs=") == 0){
+            jobs = std::max(std::atoi(arg.c_str() + 7), 0);
+        }
+        else if(arg.find('=') == string::npos || false == expand(arg, grid)){
+
+            std::cerr << "ERROR: Invalid setting: " << arg << endl;
+            return ERR_ARG_NUM;
+        }
+    }
+
+    /* Jobs are the unit of parallelism, each one runs on a single core. */
+    cv::setNumThreads(0);
+
+    vector<sweepJob> results(grid.size());
+
+    /* The calling thread runs jobs too, a single one at a time needs no pool at all. */
+    std::unique_ptr<workerPool> pool;
+    if(jobs != 1){
+        pool.reset(new workerPool(jobs - 1));
+    }
+    int threads = pool ? pool -> size() : 1;
+
+    cout << grid.size() << " configurations on " << threads << " threads" << endl;
+
+    auto run = [&](int i){
+
+        sweepJob& job = results[i];
+        job.cfg = grid[i];
+
+        vector<motBox> hyp;
+        job.ok = runJob(input, job, hyp);
+
+        if(job.ok){
+            job.scores = func::evaluateMOT(gt, hyp);
+        }
+    };
+
+    if(pool){
+        pool -> parallelFor(grid.size(), run);
+    }
+    else{
+        for(size_t i = 0; i < grid.size(); ++ i){
+            run(i);
+        }
+    }
+
+    /* Failed jobs are reported and left out of the table, the sweep fails only if none ran. */
+    size_t failed = 0;
+
+    for(const sweepJob& job: results){
+
+        if(false == job.ok){
+
+            std::cerr << "ERRO: " << job.error << " (" << job.cfg.str() << ")" << endl;
+            ++ failed;
+        }
+    }
+
+    if(failed == results.size()){
+        return 1;
+    }
+
+    results.erase(std::remove_if(results.begin(), results.end(), 
+                                 [](const sweepJob& job){ return false == job.ok; }), results.end());
+
+    for(sweepJob& job: results){
+
+        job.pareto = true;
+
+        for(const sweepJob& other: results){
+
+            bool no_worse = other.fps >= job.fps && other.scores.mota >= job.scores.mota
+                            && other.scores.idf1 >= job.scores.idf1;
+            bool better = other.fps > job.fps || other.scores.mota > job.scores.mota
+                            || other.scores.idf1 > job.scores.idf1;
+
+            if(no_worse && better){
+                job.pareto = false;
+                break;
+            }
+        }
+    }
+
+    std::sort(results.begin(), results.end(), 
+              [](const sweepJob& a, const sweepJob& b){ return a.fps > b.fps; });
+
+    std::printf("  %9s %7s %7s %6s %6s %5s  %s\n", "fps", "MOTA", "IDF1", "FP", "FN", "IDSW", "settings");
+
+    for(const sweepJob& job: results){
+
+        std::printf("%c %9.1f %7.3f %7.3f %6ld %6ld %5ld  %s\n", job.pareto ? '*' : ' ', job.fps, 
+                    job.scores.mota, job.scores.idf1, job.scores.fp, job.scores.fn, job.scores.idsw, 
+                    job.cfg.str().c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file tracksink.cpp
+ * @brief Asynchronous output of the tracks.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "tracksink.hpp"
+
+
+/**
+ * @brief Create the output file and start the writer thread.
+ *
+ * @param path      Path to the output file. An existing file is overwritten.
+ * @param format    `SINK_FORMAT_MOT` or `SINK_FORMAT_BINARY`. Default value is `SINK_FORMAT`.
+ * @param policy    `SINK_DROP` or `SINK_BLOCK`, when the ring is full. Default value is `SINK_POLICY`.
+ * @param capacity  Records the ring holds. Default value is `SINK_RING_SIZE`.
+ *
+ */
+trackSink::trackSink(const string& path, int format, int policy, int capacity)
+    : _format(format), _policy(policy), _ring(capacity){
+
+    _file = std::fopen(path.c_str(), format == SINK_FORMAT_BINARY ? "wb" : "w");
+
+    if(_file != nullptr){
+        _writer = std::thread(&trackSink::work, this);
+    }
+}
+
+/**
+ * @brief Write what is left in the ring, then close the file.
+ *
+ */
+trackSink::~trackSink(){
+
+    _stop.store(true, std::memory_order_release);
+
+    if(_writer.joinable()){
+        _writer.join();
+    }
+
+    if(_file != nullptr){
+        std::fclose(_file);
+    }
+}
+
+bool trackSink::isOpened(void) const{
+
+    return _file != nullptr;
+}
+
+/**
+ * @brief Get the number of records dropped because the ring was full.
+ *
+ */
+long trackSink::dropped(void) const{
+
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Publish the results of one frame. Only called from one thread.
+ *
+ * @param frame     Frame number, from 1.
+ * @param results   Results of the running trackers.
+ *
+ * @return Boolean value. Return `false` if records were dropped.
+ *
+ */
+bool trackSink::publish(int frame, const vector<tcrResult>& results){
+
+    if(false == isOpened()){
+        return false;
+    }
+
+    bool all_published = true;
+
+    for(const tcrResult& res: results){
+
+        trackRecord record = {frame, res.id, (float)res.roi.x, (float)res.roi.y, 
+            (float)res.roi.width, (float)res.roi.height, res.apce, res.peak, 
+            (int8_t)res.state, (int8_t)res.accepted, 0, 0};
+
+        if(_policy == SINK_BLOCK){
+            _ring.push(record);
+        }
+        else if(false == _ring.tryPush(record)){
+
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            all_published = false;
+        }
+    }
+
+    return all_published;
+}
+
+/**
+ * @brief Writer thread. Takes records out in batches until stopped and the ring is empty.
+ *
+ */
+void trackSink::work(void){
+
+    vector<trackRecord> batch;
+    batch.reserve(SINK_BATCH);
+
+    for(;;){
+
+        /* Read before draining, so that everything published before the stop gets written. */
+        bool stopping = _stop.load(std::memory_order_acquire);
+
+        trackRecord record;
+        while((int)batch.size() < SINK_BATCH && _ring.tryPop(record)){
+            batch.push_back(record);
+        }
+
+        if(false == batch.empty()){
+
+            writeBatch(batch);
+            batch.clear();
+            continue;
+        }
+
+        if(stopping){
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(SINK_IDLE_MS));
+    }
+}
+
+/**
+ * @brief Write and flush one batch of records.
+ *
+ * MOT lines are `frame,id,x,y,w,h,conf,-1,-1,-1`, with ids from 1 and the peak as confidence.
+ *
+ */
+bool trackSink::writeBatch(const vector<trackRecord>& batch){
+
+    bool ok = true;
+
+    if(_format == SINK_FORMAT_BINARY){
+
+        ok = std::fwrite(batch.data(), sizeof(trackRecord), batch.size(), _file) == batch.size();
+    }
+    else{
+
+        for(const trackRecord& r: batch){
+
+            ok = std::fprintf(_file, "%d,%d,%.2f,%.2f,%.2f,%.2f,%.4f,-1,-1,-1\n", 
+                              r.frame, r.id + 1, r.x, r.y, r.w, r.h, r.peak) > 0 && ok;
+        }
+    }
+
+    return (std::fflush(_file) == 0) && ok;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#ifndef _TRACKSINK_H_
+#define _TRACKSINK_H_
+
+#include "funcs.hpp"
+#include "track.hpp"
+#include "pipeline.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+/* Output formats. MOT is the MOTChallenge text format, BINARY the `trackRecord` structs as is. */
+#define SINK_FORMAT_MOT (0)
+#define SINK_FORMAT_BINARY (1)
+
+/* What publishing does when the ring is full: drop the records, or wait for the writer. */
+#define SINK_DROP (0)
+#define SINK_BLOCK (1)
+
+#define SINK_FORMAT (SINK_FORMAT_MOT)
+#define SINK_POLICY (SINK_DROP)
+
+/* Records the ring holds, and records written per batch. */
+#define SINK_RING_SIZE (4096)
+#define SINK_BATCH (256)
+
+/* Sleep of the writer when the ring is empty, in milliseconds. */
+#define SINK_IDLE_MS (5)
+
+
+/**
+ * @struct trackRecord
+ * @brief One tracker in one frame, as written by `trackSink`. Fixed size, 40 bytes.
+ *
+ */
+struct trackRecord{
+
+    int32_t frame;
+    int32_t id;
+    float x;
+    float y;
+    float w;
+    float h;
+    float apce;
+    float peak;
+    int8_t state;
+    int8_t accepted;
+    int16_t reserved;
+    int32_t reserved_2;
+};
+
+
+/**
+ * @class trackSink
+ * @brief Writes tracks to a file on a background thread.
+ *
+ * The frame loop publishes into a preallocated lock-free ring and never waits for I/O. 
+ * The writer thread takes records out in batches and writes and flushes each batch.
+ *
+ */
+class trackSink{
+
+public:
+
+    trackSink(const string& path, int format = SINK_FORMAT, int policy = SINK_POLICY, 
+        int capacity = SINK_RING_SIZE);
+    ~trackSink();
+
+    bool isOpened(void) const;
+
+    bool publish(int frame, const vector<tcrResult>& results);
+
+    long dropped(void) const;
+
+private:
+
+    void work(void);
+    bool writeBatch(const vector<trackRecord>& batch);
+
+    std::FILE* _file = nullptr;
+    int _format;
+    int _policy;
+
+    /* The frame loop produces, the writer thread consumes. */
+    spscQueue<trackRecord> _ring;
+
+    std::thread _writer;
+    std::atomic<bool> _stop{false};
+    std::atomic<long> _dropped{0};
+};
+
+
+#endif
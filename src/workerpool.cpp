@@ -0,0 +1,139 @@
+/**
+ * @file workerpool.cpp
+ * @brief Worker pool shared by the streams and the trackers of the MOT system.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "workerpool.hpp"
+
+#include <algorithm>
+
+
+/**
+ * @brief Start the worker threads.
+ *
+ * @param threads   Number of worker threads. `POOL_THREADS` (0) starts one per core 
+ *                  besides the calling thread.
+ *
+ */
+workerPool::workerPool(int threads){
+
+    if(threads <= 0){
+        threads = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+    }
+
+    for(int i = 0; i < threads; ++ i){
+        _workers.emplace_back(&workerPool::work, this);
+    }
+}
+
+workerPool::~workerPool(){
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cond.notify_all();
+
+    for(std::thread& worker: _workers){
+        worker.join();
+    }
+}
+
+int workerPool::size(void) const{
+
+    return _workers.size() + 1;
+}
+
+/**
+ * @brief Run `body(0)` to `body(n - 1)` on the workers and the calling thread.
+ *
+ * Returns when all the items are done. Items are claimed one at a time, so uneven ones 
+ * balance out.
+ *
+ * @param n         Number of items.
+ * @param body      Work of one item.
+ *
+ */
+void workerPool::parallelFor(int n, const std::function<void(int)>& body){
+
+    if(n <= 0){
+        return;
+    }
+
+    if(n == 1 || _workers.empty()){
+
+        for(int i = 0; i < n; ++ i){
+            body(i);
+        }
+        return;
+    }
+
+    job cur_job;
+    cur_job.body = &body;
+    cur_job.n = n;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(&cur_job);
+    }
+    _cond.notify_all();
+
+    for(int i = cur_job.next.fetch_add(1); i < n; i = cur_job.next.fetch_add(1)){
+
+        body(i);
+        cur_job.done.fetch_add(1, std::memory_order_release);
+    }
+
+    /* No worker claims anything more once the job is off the queue. */
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = std::find(_jobs.begin(), _jobs.end(), &cur_job);
+        if(it != _jobs.end()){
+            _jobs.erase(it);
+        }
+    }
+
+    /* Items claimed by workers are still running. */
+    while(cur_job.done.load(std::memory_order_acquire) < n){
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * @brief Worker thread. Claims items of the oldest job, one at a time.
+ *
+ */
+void workerPool::work(void){
+
+    for(;;){
+
+        job* cur_job = nullptr;
+        int i = 0;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cond.wait(lock, [&](){ return _stop || false == _jobs.empty(); });
+
+            if(_stop){
+                return;
+            }
+
+            cur_job = _jobs.front();
+            i = cur_job -> next.fetch_add(1);
+
+            /* All claimed, the job is left to the threads running it. */
+            if(i >= cur_job -> n){
+                _jobs.pop_front();
+                continue;
+            }
+        }
+
+        (*cur_job -> body)(i);
+
+        /* Last access, the caller may return right after. */
+        cur_job -> done.fetch_add(1, std::memory_order_release);
+    }
+}
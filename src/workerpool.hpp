@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef _WORKERPOOL_H_
+#define _WORKERPOOL_H_
+
+#include "funcs.hpp"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+/* Worker threads of the shared pool, 0 for one per core besides the calling thread. */
+#define POOL_THREADS (0)
+
+
+/**
+ * @class workerPool
+ * @brief Fixed set of worker threads shared by all the work of the process.
+ *
+ * `parallelFor` may be called from inside a body. The caller always works on its own items too,
+ * so a nested call makes progress even when all workers are busy.
+ *
+ */
+class workerPool{
+
+public:
+
+    explicit workerPool(int threads = POOL_THREADS);
+    ~workerPool();
+
+    void parallelFor(int n, const std::function<void(int)>& body);
+
+    /* Threads that run bodies, the calling thread included. */
+    int size(void) const;
+
+private:
+
+    /* One `parallelFor` call. It lives on the caller's stack. */
+    struct job{
+
+        const std::function<void(int)>* body;
+        int n;
+
+        /* Next item to claim, and items finished. */
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+    };
+
+    void work(void);
+
+    vector<std::thread> _workers;
+
+    /* Guards `_jobs` and `_stop`. Workers claim items only while holding it. */
+    std::mutex _mutex;
+    std::condition_variable _cond;
+
+    std::deque<job*> _jobs;
+    bool _stop = false;
+};
+
+
+#endif
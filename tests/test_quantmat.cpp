@@ -0,0 +1,97 @@
+/**
+ * @file test_quantmat.cpp
+ * @brief Reduced precision KCF models: blending small updates into a stored model must follow
+ *        the same blend done in float32.
+ * @author wantSomeChips
+ * @date 2025
+ *
+ */
+
+#include "quantmat.hpp"
+
+#include <cmath>
+#include <iostream>
+
+#define CHECK(cond) \
+    if(!(cond)){ std::cerr << "FAIL: " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; return 1; }
+
+
+/* Deterministic values in [-amplitude, amplitude], a different pattern for each seed. */
+static cv::Mat pattern(int rows, int cols, float amplitude, float seed){
+
+    cv::Mat m(rows, cols, CV_32F);
+
+    for(int i = 0; i < rows; ++ i){
+        for(int j = 0; j < cols; ++ j){
+            m.at<float>(i, j) = amplitude * std::sin(seed * (i * cols + j + 1) + 0.37f * i);
+        }
+    }
+
+    return m;
+}
+
+/**
+ * @brief Blend `target` into a model `frames` times, stored at `precision` after every blend,
+ *        as `KCFTracker::train` does.
+ *
+ * @return Largest difference between the dequantized model and the float32 one, in units of
+ *         `step` times the largest magnitude of the float32 model.
+ *
+ */
+static double blendError(int precision, float amplitude, float factor, int frames, double step){
+
+    const int rows = 4, cols = 64;
+
+    cv::Mat ref = pattern(rows, cols, amplitude, 0.7f);
+    cv::Mat target = pattern(rows, cols, amplitude, 1.3f);
+
+    quantizedMat q;
+    q.store(ref, precision, rows);
+
+    cv::Mat model, loaded;
+
+    for(int k = 0; k < frames; ++ k){
+
+        ref = (1 - factor) * ref + factor * target;
+
+        q.loadForUpdate(model);
+        model = (1 - factor) * model + factor * target;
+        q.store(model, precision, rows);
+    }
+
+    q.load(loaded);
+
+    return cv::norm(loaded, ref, cv::NORM_INF) / (step * cv::norm(ref, cv::NORM_INF));
+}
+
+
+int main(void){
+
+    /* Learning rates of the tracker, each step far below half an int8 step of the model.
+       Rounding alone keeps the model within half a step of the float32 one. */
+    CHECK(blendError(QMAT_INT8, 1.0f, 0.005f, 400, 1.0 / 127) < 1.0);
+    CHECK(blendError(QMAT_INT8, 1.0f, 0.012f, 400, 1.0 / 127) < 1.0);
+
+    /* Large values, where fp16 steps are coarse too. */
+    CHECK(blendError(QMAT_FLOAT16, 1000.0f, 0.005f, 400, 1.0 / 1024) < 1.0);
+
+    /* The model moved towards the target, it didn't stay at the first template. */
+    quantizedMat q;
+    cv::Mat model = pattern(1, 64, 1.0f, 0.7f), target = pattern(1, 64, 1.0f, 1.3f), loaded;
+    const double start = cv::norm(model, target, cv::NORM_INF);
+
+    q.store(model, QMAT_INT8, 1);
+    for(int k = 0; k < 400; ++ k){
+
+        q.loadForUpdate(model);
+        model = (1 - 0.005f) * model + 0.005f * target;
+        q.store(model, QMAT_INT8, 1);
+    }
+    q.load(loaded);
+
+    CHECK(cv::norm(loaded, target, cv::NORM_INF) < 0.25 * start);
+
+    std::cout << "PASS: test_quantmat" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test_reid.cpp
+ * @brief Re-identification gallery when it's full: matching must see the gallery after eviction.
+ * @author wantSomeChips
+ * @date 2025
+ * 
+ */
+
+#include "reid.hpp"
+
+#define CHECK(cond) \
+    if(!(cond)){ std::cerr << "FAIL: " << __FILE__ << ":" << __LINE__ << ": " #cond << endl; return 1; }
+
+
+static Mat descriptor(float value){
+
+    return Mat(1, 8, CV_32FC1, cv::Scalar(value));
+}
+
+
+int main(void){
+
+    const Rect near(100, 100, 20, 50), far(500, 300, 20, 50);
+    const cv::Point2f still(0.0f, 0.0f);
+
+    /* Full gallery. Track 1 is the oldest entry, lost next to where a detection comes. */
+    reidGallery gallery(2);
+
+    CHECK(gallery.push(1, descriptor(0.1f), near, still, 1, nullptr) == nullptr);
+    CHECK(gallery.push(2, descriptor(0.5f), far, still, 2, nullptr) == nullptr);
+    CHECK(gallery.count() == 2);
+    CHECK(gallery.match(descriptor(0.1f), near, 3) != INVALID_INDEX);
+
+    /* Taking over a lost tracker archives it, which evicts track 1. 
+       A match made after it no longer finds the evicted track, only what the gallery holds now. */
+    gallery.push(3, descriptor(0.9f), far, still, 3, nullptr);
+    CHECK(gallery.count() == 2);
+
+    int entry = gallery.match(descriptor(0.1f), near, 3);
+    CHECK(entry == INVALID_INDEX);
+
+    /* The newly archived track 3 is found where it was lost, and can be taken. */
+    entry = gallery.match(descriptor(0.9f), far, 3);
+    CHECK(entry != INVALID_INDEX);
+
+    int id = reidGallery::INVALID_ID;
+    gallery.take(entry, id);
+    CHECK(id == 3);
+    CHECK(gallery.count() == 1);
+
+    cout << "PASS: test_reid" << endl;
+
+    return 0;
+}